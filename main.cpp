@@ -2,21 +2,53 @@
 
 #include "mbed.h"
 #include "arm_book_lib.h"
+#include "FlashIAP.h"
+#include "MbedCRC.h"
 #include <vector>
 //=====[Defines]===============================================================
 
 #define NUMBER_OF_KEYS                           4
+#define TIME_INCREMENT_MS                       10
+#define KEYPAD_NUMBER_OF_ROWS                    4
+#define KEYPAD_NUMBER_OF_COLS                    4
+#define EVENT_NAME_MAX_LENGTH                   14
+#define UART_LINE_MAX_LENGTH                    64
+#define UART_LINE_TIMEOUT_MS                  1000
+#define RTC_EPOCH_MAX                   0x7FFFFFFF
+
+//GRUPO. Valores por defecto de la configuración (se pueden cambiar por UART y quedan guardados en la flash).
 #define BLINKING_TIME_GAS_ALARM               1000
 #define BLINKING_TIME_OVER_TEMP_ALARM          500
 #define BLINKING_TIME_GAS_AND_OVER_TEMP_ALARM  100
 #define NUMBER_OF_AVG_SAMPLES                   100
 #define OVER_TEMP_LEVEL                         50
-#define TIME_INCREMENT_MS                       10
 #define DEBOUNCE_KEY_TIME_MS                    40
-#define KEYPAD_NUMBER_OF_ROWS                    4
-#define KEYPAD_NUMBER_OF_COLS                    4
 #define EVENT_MAX_STORAGE                      100
-#define EVENT_NAME_MAX_LENGTH                   14
+
+//GRUPO. Rangos válidos de la configuración. Los máximos de los arreglos definen la memoria reservada.
+#define OVER_TEMP_LEVEL_MAX                    150
+#define NUMBER_OF_AVG_SAMPLES_MAX              200
+#define EVENT_MAX_STORAGE_MAX                10000
+#define DEBOUNCE_KEY_TIME_MS_MAX              1000
+#define BLINKING_TIME_MS_MAX                 10000
+
+#define SYSTEM_CONFIG_MAGIC             0x47464353
+#define SYSTEM_CONFIG_VERSION                    2
+#define SYSTEM_CONFIG_STORAGE_SIZE              64
+#define SYSTEM_CONFIG_NUMBER_OF_FIELDS           7
+
+#define CAPTURE_MAGIC                   0x32504143
+#define CAPTURE_BLOCK_SIZE                     256
+#define CAPTURE_NUMBER_OF_BLOCKS                15
+#define CAPTURE_RECORD_MAX_SIZE                  4
+
+#define CAPTURE_FLAG_ALARM                    0x01
+#define CAPTURE_FLAG_OVER_TEMP_DETECTOR       0x02
+#define CAPTURE_FLAG_GAS_DETECTOR_STATE       0x04
+#define CAPTURE_FLAG_OVER_TEMP_DETECTOR_STATE 0x08
+#define CAPTURE_FLAG_INCORRECT_CODE_LED       0x10
+#define CAPTURE_FLAG_SYSTEM_BLOCKED_LED       0x20
+#define CAPTURE_FLAG_SEGMENT_START            0x80
 
 //=====[Declaration of public data types]======================================
 
@@ -27,11 +59,127 @@ typedef enum {
     MATRIX_KEYPAD_KEY_HOLD_PRESSED
 } matrixKeypadState_t;
 
+//GRUPO. Elementos del sistema que generan eventos. El orden coincide con systemElementNames.
+typedef enum {
+    SYSTEM_ELEMENT_ALARM,
+    SYSTEM_ELEMENT_GAS_DET,
+    SYSTEM_ELEMENT_OVER_TEMP,
+    SYSTEM_ELEMENT_LED_IC,
+    SYSTEM_ELEMENT_LED_SB,
+    SYSTEM_ELEMENT_NUMBER
+} systemElement_t;
+
+/*  GRUPO:  Evento empaquetado en 8 bytes, así entran 10000 en unos 80 KB. El nombre ("ALARM_ON", etc.) se arma
+            al mostrarlo a partir de element y state. previousDistance enlaza con el evento anterior del mismo
+            elemento (cuántos eventos más atrás está, 0 si no hay). Si ese evento ya fue pisado en el buffer
+            circular queda por debajo del más viejo guardado, así el enlace se detecta como vencido sin borrarlo.
+*/
 typedef struct systemEvent {
-    time_t seconds;
-    char typeOfEvent[EVENT_NAME_MAX_LENGTH];
+    uint32_t seconds;
+    uint32_t element : 3;
+    uint32_t state : 1;
+    uint32_t previousDistance : 28;
 } systemEvent_t;
 
+//GRUPO. Índice por elemento que se actualiza al agregar cada evento, para no recorrer todo el registro.
+typedef struct systemElementIndex {
+    uint32_t lastSequence;
+    bool state;
+    int numberOfOnTransitions;
+    time_t onSinceSeconds;
+    time_t accumulatedOnSeconds;
+} systemElementIndex_t;
+
+/*  GRUPO:  Bloque de configuración guardado en el último sector de la flash. El CRC cubre los bytes que siguen
+            al encabezado (hasta size). Los campos nuevos se agregan SIEMPRE al final: un bloque de una versión
+            anterior es un prefijo del actual, así que al migrar se copian los campos conocidos y el resto toma
+            el valor por defecto.
+            - Versión 1: umbrales y tiempos.
+            - Versión 2: agrega el código de desactivación.
+*/
+typedef struct systemConfigHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    uint32_t crc;
+} systemConfigHeader_t;
+
+typedef struct systemConfig {
+    systemConfigHeader_t header;
+    uint16_t overTempLevel;
+    uint16_t numberOfAvgSamples;
+    uint16_t debounceKeyTimeMs;
+    uint16_t blinkingTimeGasAlarmMs;
+    uint16_t blinkingTimeOverTempAlarmMs;
+    uint16_t blinkingTimeGasAndOverTempAlarmMs;
+    uint16_t eventMaxStorage;
+    uint16_t reserved;
+    char codeSequence[NUMBER_OF_KEYS];
+} systemConfig_t;
+
+//GRUPO. Entradas muestreadas una vez por ciclo. La captura graba esta estructura en cada ciclo.
+typedef struct systemInputs {
+    uint16_t lm35Raw;
+    bool gasDetected;
+    bool alarmTestButtonPressed;
+    uint8_t keyScanned;
+} systemInputs_t;
+
+/*  GRUPO:  Captura de entradas en un buffer circular de bloques. Cada bloque empieza con un keyframe y sigue con
+            un registro por ciclo:
+            - 0zzzzzzz: entradas digitales sin cambios y delta del lm35 en zigzag (|delta| <= 63), 1 byte.
+            - 1bgkkkkk: b = botón (bit 6), g = gas (bit 5), k = tecla escaneada + 1; sigue el delta en zigzag
+              como varint.
+            Al llenarse un bloque se pasa al siguiente pisando el más viejo, así siempre quedan los últimos
+            ciclos antes de una falsa alarma.
+*/
+
+/*  GRUPO:  El keyframe guarda las entradas del ciclo y el estado del firmware al terminarlo, así un replay puede
+            arrancar desde el bloque más viejo que quedó aunque el buffer ya haya dado la vuelta. Del promedio del
+            LM35 se guarda solo el valor actual, no las muestras. eventsSequence es el último evento registrado
+            hasta ese ciclo. CAPTURE_FLAG_SEGMENT_START marca el primer keyframe de una captura o después de un
+            reset: ahí el estado no sigue del bloque anterior.
+*/
+typedef struct captureKeyframe {
+    uint16_t lm35Raw;
+    uint8_t digital;
+    uint8_t flags;
+    uint32_t eventsSequence;
+    float lm35ReadingsAverage;
+    uint8_t numberOfIncorrectCodes;
+    uint8_t matrixKeypadState;
+    char matrixKeypadLastKeyPressed;
+    uint8_t matrixKeypadCodeIndex;
+    char keyPressed[NUMBER_OF_KEYS];
+    uint16_t accumulatedDebounceMatrixKeypadTime;
+    uint16_t reserved;
+} captureKeyframe_t;
+
+typedef struct captureBlock {
+    uint16_t length;
+    uint8_t data[CAPTURE_BLOCK_SIZE - sizeof( uint16_t )];
+} captureBlock_t;
+
+typedef struct inputCapture {
+    uint32_t magic;
+    uint32_t ticksRecorded;
+    uint8_t recording;
+    uint8_t currentBlock;
+    uint8_t numberOfBlocks;
+    uint8_t eventLogValid;
+    uint32_t lastEventsSequence;
+    captureBlock_t blocks[CAPTURE_NUMBER_OF_BLOCKS];
+} inputCapture_t;
+
+//GRUPO. Valores que se calculan una sola vez cuando cambia la configuración y no en cada ciclo del loop.
+typedef struct systemConfigDerived {
+    float overTempLevelRaw;
+    float numberOfAvgSamplesInverse;
+    int blinkingTicksGasAlarm;
+    int blinkingTicksOverTempAlarm;
+    int blinkingTicksGasAndOverTempAlarm;
+} systemConfigDerived_t;
+
 //=====[Declaration and initialization of public global objects]===============
 
 DigitalIn alarmTestButton(BUTTON1);
@@ -43,10 +191,13 @@ DigitalOut systemBlockedLed(LED2);
 
 DigitalInOut sirenPin(PE_10);
 
-UnbufferedSerial uartUsb(USBTX, USBRX, 115200);
+//GRUPO. BufferedSerial guarda lo recibido mientras el loop duerme, así una trama completa no se pierde.
+BufferedSerial uartUsb(USBTX, USBRX, 115200);
 
 AnalogIn lm35(A1);
 
+FlashIAP flash;
+
 /*  GRUPO:  Punto 7-C:
     El microcontrolador cuenta con dos dominios de backup, una memoria SRAM de 4Kbytes y 20 registros de backup alimentados
     por VBAT cuando VDD no se encuentra encendida.
@@ -75,7 +226,7 @@ int numberOfHashKeyReleasedEvents = 0;
 int keyBeingCompared    = 0;
 char codeSequence[NUMBER_OF_KEYS]   = { '1', '8', '0', '5' };
 char keyPressed[NUMBER_OF_KEYS] = { '0', '0', '0', '0' };
-int accumulatedTimeAlarm = 0;
+int accumulatedTicksAlarm = 0;
 
 bool alarmLastState        = OFF;
 bool gasLastState          = OFF;
@@ -89,8 +240,9 @@ bool overTempDetectorState     = OFF;
 float potentiometerReading = 0.0;
 float lm35ReadingsAverage  = 0.0;
 float lm35ReadingsSum      = 0.0;
-float lm35ReadingsArray[NUMBER_OF_AVG_SAMPLES];
+float lm35ReadingsArray[NUMBER_OF_AVG_SAMPLES_MAX];
 float lm35TempC            = 0.0;
+int lm35SampleIndex        = 0;
 
 int accumulatedDebounceMatrixKeypadTime = 0;
 int matrixKeypadCodeIndex = 0;
@@ -103,13 +255,56 @@ char matrixKeypadIndexToCharArray[] = {
 };
 matrixKeypadState_t matrixKeypadState;
 
+char uartLineCommand = '\0';
+char uartLine[UART_LINE_MAX_LENGTH];
+int uartLineLength = 0;
+bool uartLineOverflow = false;
+int uartLineIdleTicks = 0;
+
 int eventsIndex = 0;
-systemEvent_t arrayOfStoredEvents[EVENT_MAX_STORAGE];
+int numberOfStoredEvents = 0;
+uint32_t eventsSequence = 0;
+uint32_t eventsSortedFromSequence = 0;
+uint32_t eventsLastSeconds = 0;
+systemEvent_t arrayOfStoredEvents[EVENT_MAX_STORAGE_MAX];
+systemElementIndex_t systemElementIndexes[SYSTEM_ELEMENT_NUMBER];
+const char* systemElementNames[SYSTEM_ELEMENT_NUMBER] = {
+    "ALARM", "GAS_DET", "OVER_TEMP", "LED_IC", "LED_SB"
+};
+
+systemConfig_t systemConfig;
+systemConfigDerived_t systemConfigDerived;
+uint32_t systemConfigFlashAddress = 0;
+uint32_t systemConfigSectorSize = 0;
+uint32_t systemConfigNextOffset = 0;
+bool systemConfigFlashAvailable = false;
+
+systemInputs_t inputs;
+inputCapture_t* capture = NULL;
+uint16_t captureLastLm35Raw = 0;
+uint8_t captureLastDigital = 0;
+bool captureSegmentStart = false;
+uint32_t captureMaxTickUs = 0;
+uint32_t captureTotalUs = 0;
+uint32_t captureMeasuredTicks = 0;
+#if !defined(BKPSRAM_BASE)
+inputCapture_t inputCaptureRam;
+#endif
+
+static_assert( sizeof( systemConfig_t ) <= SYSTEM_CONFIG_STORAGE_SIZE,
+               "systemConfig_t does not fit in SYSTEM_CONFIG_STORAGE_SIZE" );
+static_assert( sizeof( systemEvent_t ) == 8,
+               "systemEvent_t is expected to be packed in 8 bytes" );
+static_assert( sizeof( captureKeyframe_t ) == 24 && sizeof( captureKeyframe_t ) <= sizeof( captureBlock_t::data ),
+               "captureKeyframe_t is expected to be packed in 24 bytes" );
+static_assert( sizeof( inputCapture_t ) <= 4096,
+               "inputCapture_t does not fit in the backup SRAM" );
 
 //=====[Declarations (prototypes) of public functions]=========================
 
 void inputsInit();
 void outputsInit();
+void inputsUpdate();
 
 void alarmActivationUpdate();
 void alarmDeactivationUpdate();
@@ -118,10 +313,51 @@ void uartTask();
 void availableCommands();
 bool areEqual();
 
+void uartLineStart( char command );
+void uartLineUpdate();
+void uartLineDispatch( char command, char* line, bool lineValid );
+int digitsToInt( const char* str, int numberOfDigits, unsigned int* invalidMask );
+bool rtcTimeParse( const char* str, time_t* epochSeconds );
+void rtcTimeSet( time_t newEpochSeconds );
+bool bulkConfigParseAndApply( char* str );
+
+void systemConfigInit();
+void systemConfigDefaults( systemConfig_t* config );
+bool systemConfigValidate( systemConfig_t* config );
+uint32_t systemConfigCrc( const uint8_t* block, int size );
+bool systemConfigLoad();
+bool systemConfigSave();
+void systemConfigApply();
+void systemConfigPrint();
+bool systemConfigParseAndWrite( char* str );
+
 void eventLogUpdate();
 void systemElementStateUpdate( bool lastState,
                                bool currentState,
-                               const char* elementName );
+                               systemElement_t element );
+
+void eventLogClear();
+void eventPrint( const systemEvent_t* event );
+bool eventLogQuery( char* str );
+void eventLogQueryLast( int numberOfEvents );
+void eventLogQueryFilter( int element, time_t fromSeconds, time_t toSeconds );
+int eventLogLowerBound( time_t seconds, int low );
+void eventLogQueryStats();
+void eventLogQuerySequence( uint32_t afterSequence, uint32_t lastSequence );
+
+void captureInit();
+bool captureIsValid();
+void captureStart();
+void captureUpdate();
+uint8_t captureDigitalByte();
+void captureKeyframeWrite( captureBlock_t* block, uint8_t digital );
+int captureVarintWrite( uint8_t* data, uint32_t value );
+void captureBlockAdvance();
+int captureBlockIndex( int i );
+int captureReplayStartBlock();
+void captureStatusPrint();
+void captureDump();
+void captureEventsPrint();
 
 float celsiusToFahrenheit( float tempInCelsiusDegrees );
 float analogReadingScaledWithTheLM35Formula( float analogReading );
@@ -141,10 +377,12 @@ int main()
     outputsInit();
     availableCommands();
     while (true) {
+        inputsUpdate();
         alarmActivationUpdate();
         alarmDeactivationUpdate();
         uartTask();
         eventLogUpdate();
+        captureUpdate();
         //GRUPO. TIME_INCREMENT_MS (10ms): Periodicidad con la que se activa la maquina de estados (aproximadamente)
         delay(TIME_INCREMENT_MS);
     }
@@ -154,6 +392,7 @@ int main()
 
 void inputsInit()
 {
+    systemConfigInit();
     lm35ReadingsArrayInit();
     alarmTestButton.mode(PullDown);
     //GRUPO: PARA PRENDER LA ALARMA.
@@ -161,6 +400,7 @@ void inputsInit()
     sirenPin.mode(OpenDrain);
     sirenPin.input();
     matrixKeypadInit();
+    captureInit();
 }
 
 void outputsInit()
@@ -170,31 +410,40 @@ void outputsInit()
     systemBlockedLed = OFF;
 }
 
+//GRUPO: La tecla se lee en matrixKeypadScan(), que también la deja en inputs.
+void inputsUpdate()
+{
+    //GRUPO: El ADC es de 12 bits; se guarda sin el escalado a 16 bits para que los deltas de la captura sean chicos.
+    inputs.lm35Raw = lm35.read_u16() >> 4;
+    inputs.gasDetected = !mq2;
+    inputs.alarmTestButtonPressed = alarmTestButton;
+}
+
 void alarmActivationUpdate()
 {
-    static int lm35SampleIndex = 0;
     int i = 0;
 
-    lm35ReadingsArray[lm35SampleIndex] = lm35.read();
+    lm35ReadingsArray[lm35SampleIndex] = inputs.lm35Raw / 4095.0;
     lm35SampleIndex++;
-    if ( lm35SampleIndex >= NUMBER_OF_AVG_SAMPLES) {
+    if ( lm35SampleIndex >= systemConfig.numberOfAvgSamples) {
         lm35SampleIndex = 0;
     }
     
     lm35ReadingsSum = 0.0;
-    for (i = 0; i < NUMBER_OF_AVG_SAMPLES; i++) {
+    for (i = 0; i < systemConfig.numberOfAvgSamples; i++) {
         lm35ReadingsSum = lm35ReadingsSum + lm35ReadingsArray[i];
     }
-    lm35ReadingsAverage = lm35ReadingsSum / NUMBER_OF_AVG_SAMPLES;
+    lm35ReadingsAverage = lm35ReadingsSum * systemConfigDerived.numberOfAvgSamplesInverse;
        lm35TempC = analogReadingScaledWithTheLM35Formula ( lm35ReadingsAverage );    
     
-    if ( lm35TempC > OVER_TEMP_LEVEL ) {
+    //GRUPO. Se compara contra el umbral ya convertido a la escala del ADC.
+    if ( lm35ReadingsAverage > systemConfigDerived.overTempLevelRaw ) {
         overTempDetector = ON;
     } else {
         overTempDetector = OFF;
     }
 
-    if( !mq2) {
+    if( inputs.gasDetected ) {
         gasDetectorState = ON;
         alarmState = ON;
     }
@@ -202,29 +451,29 @@ void alarmActivationUpdate()
         overTempDetectorState = ON;
         alarmState = ON;
     }
-    if( alarmTestButton ) {             
+    if( inputs.alarmTestButtonPressed ) {
         overTempDetectorState = ON;
         gasDetectorState = ON;
         alarmState = ON;
     }
     if( alarmState ) { 
-        accumulatedTimeAlarm = accumulatedTimeAlarm + TIME_INCREMENT_MS;
+        accumulatedTicksAlarm++;
         sirenPin.output();                                     
         sirenPin = LOW;                                
 
         if( gasDetectorState && overTempDetectorState ) {
-            if( accumulatedTimeAlarm >= BLINKING_TIME_GAS_AND_OVER_TEMP_ALARM ) {
-                accumulatedTimeAlarm = 0;
+            if( accumulatedTicksAlarm >= systemConfigDerived.blinkingTicksGasAndOverTempAlarm ) {
+                accumulatedTicksAlarm = 0;
                 alarmLed = !alarmLed;
             }
         } else if( gasDetectorState ) {
-            if( accumulatedTimeAlarm >= BLINKING_TIME_GAS_ALARM ) {
-                accumulatedTimeAlarm = 0;
+            if( accumulatedTicksAlarm >= systemConfigDerived.blinkingTicksGasAlarm ) {
+                accumulatedTicksAlarm = 0;
                 alarmLed = !alarmLed;
             }
         } else if ( overTempDetectorState ) {
-            if( accumulatedTimeAlarm >= BLINKING_TIME_OVER_TEMP_ALARM  ) {
-                accumulatedTimeAlarm = 0;
+            if( accumulatedTicksAlarm >= systemConfigDerived.blinkingTicksOverTempAlarm ) {
+                accumulatedTicksAlarm = 0;
                 alarmLed = !alarmLed;
             }
         }
@@ -279,6 +528,12 @@ void uartTask()
     char receivedChar = '\0';
     char str[100];
     int stringLength;
+
+    if ( uartLineCommand != '\0' ) {
+        uartLineUpdate();
+        return;
+    }
+
     if( uartUsb.readable() ) {
         uartUsb.read( &receivedChar, 1 );
         switch (receivedChar) {
@@ -291,7 +546,7 @@ void uartTask()
             break;
 
         case '2':
-            if ( !mq2 ) {
+            if ( inputs.gasDetected ) {
                 uartUsb.write( "Gas is being detected\r\n", 22);
             } else {
                 uartUsb.write( "Gas is not being detected\r\n", 27);
@@ -437,11 +692,41 @@ void uartTask()
                         La función mktime se encarga de transformar los datos de la estructura tm en la variable time_t que 
                         cuenta los segundos a partir de las 00 horas del primero de enero de 1970. 
             */
-            set_time( mktime( &rtcTime ) );
+            rtcTimeSet( mktime( &rtcTime ) );
             uartUsb.write( "Date and time has been set\r\n", 28 );
 
             break;
 
+        /*  GRUPO:  Comandos de una sola línea para el aprovisionamiento automático. El resto de la trama llega
+                    inmediatamente después de la letra del comando y termina con '\r' o '\n', por ejemplo:
+                    - "d2026-10-16T12:00:00\r" o "d1760616000\r" (fecha ISO-8601 o segundos desde 1970).
+                    - "b2026-10-16T12:00:00,1805,50\r" (fecha, código y temperatura máxima; un campo vacío no
+                      modifica el valor actual).
+                    No hay eco ni preguntas intermedias, así el script termina en un solo ida y vuelta. La línea
+                    se arma en uartLineUpdate() a lo largo de varios ciclos, sin bloquear el loop.
+        */
+        case 'd':
+        case 'D':
+        case 'b':
+        case 'B':
+        case 'w':
+        case 'W':
+        case 'l':
+        case 'L':
+            uartLineStart( receivedChar );
+            break;
+
+        //GRUPO: El '\n' que sigue al '\r' de una línea (o un Enter suelto) no es un comando.
+        case '\r':
+        case '\n':
+            break;
+
+        //GRUPO: Lectura y escritura de la configuración. La escritura usa el mismo orden que muestra 'g'.
+        case 'g':
+        case 'G':
+            systemConfigPrint();
+            break;
+
             case 't':
             case 'T':
                 time_t epochSeconds;
@@ -457,14 +742,31 @@ void uartTask()
             case 'e':
             case 'E':
                 for (int i = 0; i < eventsIndex; i++) {
-                    sprintf ( str, "Event = %s\r\n", 
-                        arrayOfStoredEvents[i].typeOfEvent);
-                    uartUsb.write( str , strlen(str) );
-                    sprintf ( str, "Date and Time = %s\r\n",
-                        ctime(&arrayOfStoredEvents[i].seconds));
-                    uartUsb.write( str , strlen(str) );
-                    uartUsb.write( "\r\n", 2 );
+                    eventPrint( &arrayOfStoredEvents[i] );
+                }
+                break;
+
+            /*  GRUPO:  Captura de las entradas:
+                        - 'r': inicia una captura nueva o la detiene, y muestra el costo por ciclo.
+                        - 'x': vuelca la configuración, la captura en hexadecimal (del bloque más viejo al más
+                          nuevo) y los eventos que el equipo registró durante la captura.
+                        El volcado se reproduce en la PC con test/replay, que compara el registro de eventos
+                        resultante con el del equipo. El equipo no reproduce la captura: la detección en vivo y
+                        el registro guardado no se interrumpen.
+            */
+            case 'r':
+            case 'R':
+                if ( capture->recording ) {
+                    capture->recording = false;
+                } else {
+                    captureStart();
                 }
+                captureStatusPrint();
+                break;
+
+            case 'x':
+            case 'X':
+                captureDump();
                 break;
 
             //GRUPO: Se agrega el comando para conocer los estados de la FSM.
@@ -492,8 +794,15 @@ void availableCommands()
     uartUsb.write( "Press 'f' or 'F' to get lm35 reading in Fahrenheit\r\n", 52 );
     uartUsb.write( "Press 'c' or 'C' to get lm35 reading in Celsius\r\n", 49 );
     uartUsb.write( "Press 's' or 'S' to set the date and time\r\n", 43 );
+    uartUsb.write( "Send 'd' + YYYY-MM-DDTHH:MM:SS or epoch to set the date and time\r\n", 66 );
+    uartUsb.write( "Send 'b' + date,code,max temperature to set the configuration\r\n", 63 );
+    uartUsb.write( "Press 'g' or 'G' to get the configuration\r\n", 43 );
+    uartUsb.write( "Send 'w' + comma separated values (same order as 'g') to write the configuration\r\n", 82 );
     uartUsb.write( "Press 't' or 'T' to get the date and time\r\n", 43 );
-    uartUsb.write( "Press 'e' or 'E' to get the stored events\r\n\r\n", 45 );
+    uartUsb.write( "Press 'r' or 'R' to start or stop the input capture\r\n", 53 );
+    uartUsb.write( "Press 'x' or 'X' to dump the input capture\r\n", 44 );
+    uartUsb.write( "Press 'e' or 'E' to get the stored events\r\n", 43 );
+    uartUsb.write( "Send 'l' + nN, fELEMENT,from,to or s to query the stored events\r\n\r\n", 67 );
     //GRUPO: Se agrega el comando para conocer los estados de la FSM.
     uartUsb.write( "Press 'q' or 'Q' to get the FSM state\r\n\r\n", 41 );
 }
@@ -511,42 +820,634 @@ bool areEqual()
     return true;
 }
 
+void uartLineStart( char command )
+{
+    uartLineCommand = command;
+    uartLineLength = 0;
+    uartLineOverflow = false;
+    uartLineIdleTicks = 0;
+}
+
+/*  GRUPO:  Toma lo que haya en el buffer de recepción sin esperar. La línea termina con '\r' o '\n'; lo que
+            llegue después queda en el buffer para el próximo ciclo. Si pasa UART_LINE_TIMEOUT_MS sin recibir
+            nada la línea se descarta, así un script que se corta no deja el comando a medias.
+*/
+void uartLineUpdate()
+{
+    char receivedChar = '\0';
+
+    while ( uartUsb.readable() ) {
+        uartUsb.read( &receivedChar, 1 );
+        uartLineIdleTicks = 0;
+        if ( receivedChar == '\r' || receivedChar == '\n' ) {
+            uartLine[uartLineLength] = '\0';
+            uartLineDispatch( uartLineCommand, uartLine, !uartLineOverflow && uartLineLength > 0 );
+            uartLineCommand = '\0';
+            return;
+        }
+        if ( uartLineLength < UART_LINE_MAX_LENGTH - 1 ) {
+            uartLine[uartLineLength] = receivedChar;
+            uartLineLength++;
+        } else {
+            uartLineOverflow = true;
+        }
+    }
+
+    uartLineIdleTicks++;
+    if ( uartLineIdleTicks * TIME_INCREMENT_MS >= UART_LINE_TIMEOUT_MS ) {
+        uartLine[uartLineLength] = '\0';
+        uartLineDispatch( uartLineCommand, uartLine, false );
+        uartLineCommand = '\0';
+    }
+}
+
+void uartLineDispatch( char command, char* line, bool lineValid )
+{
+    time_t newEpochSeconds;
+
+    switch ( command ) {
+    case 'd':
+    case 'D':
+        if ( lineValid && rtcTimeParse( line, &newEpochSeconds ) ) {
+            rtcTimeSet( newEpochSeconds );
+            uartUsb.write( "Date and time has been set\r\n", 28 );
+        } else {
+            uartUsb.write( "Invalid date and time\r\n", 23 );
+        }
+        break;
+
+    case 'b':
+    case 'B':
+        if ( lineValid && bulkConfigParseAndApply( line ) ) {
+            uartUsb.write( "Configuration has been set\r\n", 28 );
+        } else {
+            uartUsb.write( "Invalid configuration\r\n", 23 );
+        }
+        break;
+
+    //GRUPO: Escritura de la configuración, con el mismo orden que muestra 'g'.
+    case 'w':
+    case 'W':
+        if ( lineValid && systemConfigParseAndWrite( line ) ) {
+            uartUsb.write( "Configuration has been set\r\n", 28 );
+        } else {
+            uartUsb.write( "Invalid configuration\r\n", 23 );
+        }
+        break;
+
+    /*  GRUPO:  Consultas sobre el registro de eventos (se muestran del más nuevo al más viejo):
+                - "ln10\r": últimos 10 eventos.
+                - "lfALARM,2026-10-16T00:00:00,2026-10-17T00:00:00\r": eventos de un elemento en un rango
+                  de tiempo. Cualquier campo vacío no filtra; las fechas pueden ser ISO-8601 o epoch.
+                - "ls\r": cantidad de encendidos y tiempo total encendido de cada elemento.
+    */
+    case 'l':
+    case 'L':
+        if ( !lineValid || !eventLogQuery( line ) ) {
+            uartUsb.write( "Invalid query\r\n", 15 );
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+//GRUPO: Convierte dígitos ASCII sin ramas por caracter; si alguno no es dígito se marca en invalidMask.
+int digitsToInt( const char* str, int numberOfDigits, unsigned int* invalidMask )
+{
+    int value = 0;
+    int i;
+
+    for ( i = 0; i < numberOfDigits; i++ ) {
+        unsigned int digit = (unsigned int)( str[i] - '0' );
+        *invalidMask |= ( digit > 9 );
+        value = value * 10 + (int)digit;
+    }
+    return value;
+}
+
+/*  GRUPO:  Acepta "YYYY-MM-DDTHH:MM:SS" (también con un espacio en lugar de la 'T') o los segundos desde 1970
+            (hasta 10 dígitos). Todas las validaciones se acumulan en una máscara y se evalúan una sola vez.
+            Los dos formatos tienen el mismo rango: de 1970 hasta RTC_EPOCH_MAX (2038-01-19T03:14:07).
+*/
+/*  GRUPO:  Todo cambio de hora pasa por acá. El tiempo que un elemento lleva encendido se suma con el reloj
+            viejo y se sigue contando desde la hora nueva, así un salto (por ejemplo de 1970 a la fecha real al
+            aprovisionar con 'd' o 'b') no se suma como tiempo encendido.
+*/
+void rtcTimeSet( time_t newEpochSeconds )
+{
+    time_t now = time(NULL);
+    int i;
+
+    for ( i = 0; i < SYSTEM_ELEMENT_NUMBER; i++ ) {
+        if ( systemElementIndexes[i].state ) {
+            if ( now > systemElementIndexes[i].onSinceSeconds ) {
+                systemElementIndexes[i].accumulatedOnSeconds += now - systemElementIndexes[i].onSinceSeconds;
+            }
+            systemElementIndexes[i].onSinceSeconds = newEpochSeconds;
+        }
+    }
+    set_time( newEpochSeconds );
+}
+
+bool rtcTimeParse( const char* str, time_t* epochSeconds )
+{
+    static const int daysInMonth[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    unsigned int invalid = 0;
+    int length = strlen( str );
+    struct tm rtcTime;
+    int year, month, day, hour, minute, second;
+    bool leapYear;
+    time_t newEpochSeconds;
+
+    if ( length == 19 ) {
+        invalid |= ( str[4] != '-' ) | ( str[7] != '-' ) |
+                   ( ( str[10] != 'T' ) & ( str[10] != ' ' ) ) |
+                   ( str[13] != ':' ) | ( str[16] != ':' );
+        year   = digitsToInt( &str[0], 4, &invalid );
+        month  = digitsToInt( &str[5], 2, &invalid );
+        day    = digitsToInt( &str[8], 2, &invalid );
+        hour   = digitsToInt( &str[11], 2, &invalid );
+        minute = digitsToInt( &str[14], 2, &invalid );
+        second = digitsToInt( &str[17], 2, &invalid );
+        invalid |= ( year < 1970 ) | ( year > 2038 ) | ( month < 1 ) | ( month > 12 ) | ( day < 1 ) |
+                   ( hour > 23 ) | ( minute > 59 ) | ( second > 59 );
+        if ( invalid ) {
+            return false;
+        }
+
+        leapYear = ( year % 4 == 0 && year % 100 != 0 ) || ( year % 400 == 0 );
+        if ( day > daysInMonth[month - 1] + ( ( month == 2 ) & leapYear ) ) {
+            return false;
+        }
+
+        rtcTime.tm_year  = year - 1900;
+        rtcTime.tm_mon   = month - 1;
+        rtcTime.tm_mday  = day;
+        rtcTime.tm_hour  = hour;
+        rtcTime.tm_min   = minute;
+        rtcTime.tm_sec   = second;
+        rtcTime.tm_isdst = -1;
+        newEpochSeconds = mktime( &rtcTime );
+        if ( newEpochSeconds == (time_t)-1 || newEpochSeconds > RTC_EPOCH_MAX ) {
+            return false;
+        }
+        *epochSeconds = newEpochSeconds;
+        return true;
+    }
+
+    if ( length >= 1 && length <= 10 ) {
+        long long epoch = 0;
+        int i;
+        for ( i = 0; i < length; i++ ) {
+            unsigned int digit = (unsigned int)( str[i] - '0' );
+            invalid |= ( digit > 9 );
+            epoch = epoch * 10 + digit;
+        }
+        invalid |= ( epoch > RTC_EPOCH_MAX );
+        if ( invalid ) {
+            return false;
+        }
+        *epochSeconds = (time_t)epoch;
+        return true;
+    }
+
+    return false;
+}
+
+/*  GRUPO:  Trama "fecha,código,temperatura máxima". Primero se validan todos los campos y recién después se
+            aplican, así una trama con errores no deja la configuración a medio cargar.
+*/
+bool bulkConfigParseAndApply( char* str )
+{
+    char* fields[3] = { str, NULL, NULL };
+    char* separator;
+    int fieldIndex;
+    unsigned int invalid = 0;
+    time_t newEpochSeconds = 0;
+    int newOverTempLevel = systemConfig.overTempLevel;
+    systemConfig_t newConfig = systemConfig;
+    int i;
+
+    for ( fieldIndex = 1; fieldIndex < 3; fieldIndex++ ) {
+        separator = strchr( fields[fieldIndex - 1], ',' );
+        if ( separator == NULL ) {
+            return false;
+        }
+        *separator = '\0';
+        fields[fieldIndex] = separator + 1;
+    }
+    if ( strchr( fields[2], ',' ) != NULL ) {
+        return false;
+    }
+
+    if ( fields[0][0] != '\0' && !rtcTimeParse( fields[0], &newEpochSeconds ) ) {
+        return false;
+    }
+
+    if ( fields[1][0] != '\0' ) {
+        if ( strlen( fields[1] ) != NUMBER_OF_KEYS ) {
+            return false;
+        }
+        digitsToInt( fields[1], NUMBER_OF_KEYS, &invalid );
+    }
+
+    if ( fields[2][0] != '\0' ) {
+        int levelLength = strlen( fields[2] );
+        invalid |= ( levelLength > 3 );
+        newOverTempLevel = digitsToInt( fields[2], levelLength > 3 ? 3 : levelLength, &invalid );
+        invalid |= ( newOverTempLevel > OVER_TEMP_LEVEL_MAX );
+    }
+
+    if ( invalid ) {
+        return false;
+    }
+
+    if ( fields[0][0] != '\0' ) {
+        rtcTimeSet( newEpochSeconds );
+    }
+    if ( fields[1][0] != '\0' ) {
+        for ( i = 0; i < NUMBER_OF_KEYS; i++ ) {
+            newConfig.codeSequence[i] = fields[1][i];
+        }
+    }
+    newConfig.overTempLevel = newOverTempLevel;
+
+    //GRUPO: El código y la temperatura quedan guardados en la flash junto con el resto de la configuración.
+    if ( memcmp( &newConfig, &systemConfig, sizeof( systemConfig_t ) ) != 0 ) {
+        systemConfig = newConfig;
+        systemConfigApply();
+        systemConfigSave();
+    }
+    return true;
+}
+
+void systemConfigInit()
+{
+    uint32_t flashEnd;
+
+    systemConfigDefaults( &systemConfig );
+
+    if ( flash.init() == 0 ) {
+        flashEnd = flash.get_flash_start() + flash.get_flash_size();
+        systemConfigSectorSize = flash.get_sector_size( flashEnd - 1 );
+        systemConfigFlashAddress = flashEnd - systemConfigSectorSize;
+        systemConfigFlashAvailable =
+            ( SYSTEM_CONFIG_STORAGE_SIZE % flash.get_page_size() ) == 0;
+    }
+
+    if ( systemConfigFlashAvailable ) {
+        systemConfigLoad();
+    }
+    systemConfigApply();
+}
+
+void systemConfigDefaults( systemConfig_t* config )
+{
+    memset( config, 0, sizeof( systemConfig_t ) );
+    config->header.magic = SYSTEM_CONFIG_MAGIC;
+    config->header.version = SYSTEM_CONFIG_VERSION;
+    config->header.size = sizeof( systemConfig_t );
+    config->overTempLevel = OVER_TEMP_LEVEL;
+    config->numberOfAvgSamples = NUMBER_OF_AVG_SAMPLES;
+    config->debounceKeyTimeMs = DEBOUNCE_KEY_TIME_MS;
+    config->blinkingTimeGasAlarmMs = BLINKING_TIME_GAS_ALARM;
+    config->blinkingTimeOverTempAlarmMs = BLINKING_TIME_OVER_TEMP_ALARM;
+    config->blinkingTimeGasAndOverTempAlarmMs = BLINKING_TIME_GAS_AND_OVER_TEMP_ALARM;
+    config->eventMaxStorage = EVENT_MAX_STORAGE;
+    memcpy( config->codeSequence, "1805", NUMBER_OF_KEYS );
+}
+
+//GRUPO: Los campos fuera de rango vuelven a su valor por defecto. Devuelve false si hubo que corregir alguno.
+bool systemConfigValidate( systemConfig_t* config )
+{
+    systemConfig_t defaults;
+    bool valid = true;
+    int i;
+
+    systemConfigDefaults( &defaults );
+
+    if ( config->overTempLevel > OVER_TEMP_LEVEL_MAX ) {
+        config->overTempLevel = defaults.overTempLevel;
+        valid = false;
+    }
+    if ( config->numberOfAvgSamples < 1 ||
+         config->numberOfAvgSamples > NUMBER_OF_AVG_SAMPLES_MAX ) {
+        config->numberOfAvgSamples = defaults.numberOfAvgSamples;
+        valid = false;
+    }
+    if ( config->debounceKeyTimeMs > DEBOUNCE_KEY_TIME_MS_MAX ) {
+        config->debounceKeyTimeMs = defaults.debounceKeyTimeMs;
+        valid = false;
+    }
+    if ( config->blinkingTimeGasAlarmMs < TIME_INCREMENT_MS ||
+         config->blinkingTimeGasAlarmMs > BLINKING_TIME_MS_MAX ) {
+        config->blinkingTimeGasAlarmMs = defaults.blinkingTimeGasAlarmMs;
+        valid = false;
+    }
+    if ( config->blinkingTimeOverTempAlarmMs < TIME_INCREMENT_MS ||
+         config->blinkingTimeOverTempAlarmMs > BLINKING_TIME_MS_MAX ) {
+        config->blinkingTimeOverTempAlarmMs = defaults.blinkingTimeOverTempAlarmMs;
+        valid = false;
+    }
+    if ( config->blinkingTimeGasAndOverTempAlarmMs < TIME_INCREMENT_MS ||
+         config->blinkingTimeGasAndOverTempAlarmMs > BLINKING_TIME_MS_MAX ) {
+        config->blinkingTimeGasAndOverTempAlarmMs = defaults.blinkingTimeGasAndOverTempAlarmMs;
+        valid = false;
+    }
+    if ( config->eventMaxStorage < 1 ||
+         config->eventMaxStorage > EVENT_MAX_STORAGE_MAX ) {
+        config->eventMaxStorage = defaults.eventMaxStorage;
+        valid = false;
+    }
+    config->reserved = 0;
+    for ( i = 0; i < NUMBER_OF_KEYS; i++ ) {
+        if ( config->codeSequence[i] < '0' || config->codeSequence[i] > '9' ) {
+            memcpy( config->codeSequence, defaults.codeSequence, NUMBER_OF_KEYS );
+            valid = false;
+            break;
+        }
+    }
+
+    return valid;
+}
+
+//GRUPO: CRC-32 de los campos que siguen al encabezado, hasta size bytes del bloque.
+uint32_t systemConfigCrc( const uint8_t* block, int size )
+{
+    MbedCRC<POLY_32BIT_ANSI, 32> crc32;
+    uint32_t crc = 0;
+
+    crc32.compute( block + sizeof( systemConfigHeader_t ),
+                   size - sizeof( systemConfigHeader_t ), &crc );
+    return crc;
+}
+
+/*  GRUPO:  El sector se usa como un registro: cada guardado agrega un bloque de SYSTEM_CONFIG_STORAGE_SIZE
+            bytes a continuación del anterior y vale el último bloque correcto. El primer bloque borrado marca
+            dónde escribir el próximo. Un bloque con magic o CRC incorrecto (escritura interrumpida) se saltea;
+            si no queda ninguno correcto se usan los valores por defecto. Si el bloque es de otra versión se
+            copian los campos que ambas versiones comparten, se validan y se vuelve a guardar con el formato
+            actual.
+*/
+bool systemConfigLoad()
+{
+    uint8_t storage[SYSTEM_CONFIG_STORAGE_SIZE];
+    uint8_t latest[SYSTEM_CONFIG_STORAGE_SIZE];
+    systemConfigHeader_t header;
+    systemConfig_t storedConfig;
+    uint32_t offset;
+    bool found = false;
+    int copySize;
+
+    systemConfigNextOffset = systemConfigSectorSize;
+    for ( offset = 0; offset + SYSTEM_CONFIG_STORAGE_SIZE <= systemConfigSectorSize;
+          offset += SYSTEM_CONFIG_STORAGE_SIZE ) {
+        if ( flash.read( storage, systemConfigFlashAddress + offset, SYSTEM_CONFIG_STORAGE_SIZE ) != 0 ) {
+            return false;
+        }
+        memcpy( &header, storage, sizeof( header ) );
+        if ( header.magic == 0xFFFFFFFF ) {
+            systemConfigNextOffset = offset;
+            break;
+        }
+        if ( header.magic == SYSTEM_CONFIG_MAGIC &&
+             header.size >= sizeof( header ) &&
+             header.size <= SYSTEM_CONFIG_STORAGE_SIZE &&
+             systemConfigCrc( storage, header.size ) == header.crc ) {
+            memcpy( latest, storage, SYSTEM_CONFIG_STORAGE_SIZE );
+            found = true;
+        }
+    }
+    if ( !found ) {
+        return false;
+    }
+
+    memcpy( &header, latest, sizeof( header ) );
+    memcpy( storage, latest, SYSTEM_CONFIG_STORAGE_SIZE );
+    systemConfigDefaults( &storedConfig );
+    copySize = header.size < sizeof( systemConfig_t ) ? header.size : sizeof( systemConfig_t );
+    memcpy( (uint8_t*)&storedConfig + sizeof( header ), storage + sizeof( header ),
+            copySize - sizeof( header ) );
+    systemConfigValidate( &storedConfig );
+    systemConfig = storedConfig;
+
+    if ( header.version != SYSTEM_CONFIG_VERSION || header.size != sizeof( systemConfig_t ) ) {
+        systemConfigSave();
+    }
+    return true;
+}
+
+/*  GRUPO:  Agrega un bloque al final del registro. Solo cuando el sector está lleno (cada
+            sector / SYSTEM_CONFIG_STORAGE_SIZE guardados, 2048 en el F429) se borra, y ese borrado sí bloquea
+            el loop un momento.
+*/
+bool systemConfigSave()
+{
+    uint8_t storage[SYSTEM_CONFIG_STORAGE_SIZE];
+
+    if ( !systemConfigFlashAvailable ) {
+        return false;
+    }
+
+    systemConfig.header.magic = SYSTEM_CONFIG_MAGIC;
+    systemConfig.header.version = SYSTEM_CONFIG_VERSION;
+    systemConfig.header.size = sizeof( systemConfig_t );
+
+    memset( storage, 0xFF, sizeof( storage ) );
+    memcpy( storage, &systemConfig, sizeof( systemConfig_t ) );
+    systemConfig.header.crc = systemConfigCrc( storage, sizeof( systemConfig_t ) );
+    memcpy( storage, &systemConfig.header, sizeof( systemConfigHeader_t ) );
+
+    if ( systemConfigNextOffset + SYSTEM_CONFIG_STORAGE_SIZE > systemConfigSectorSize ) {
+        if ( flash.erase( systemConfigFlashAddress, systemConfigSectorSize ) != 0 ) {
+            return false;
+        }
+        systemConfigNextOffset = 0;
+    }
+    if ( flash.program( storage, systemConfigFlashAddress + systemConfigNextOffset,
+                        SYSTEM_CONFIG_STORAGE_SIZE ) != 0 ) {
+        return false;
+    }
+    systemConfigNextOffset += SYSTEM_CONFIG_STORAGE_SIZE;
+    return true;
+}
+
+//GRUPO: Recalcula los valores derivados. Se llama una vez al iniciar y cada vez que cambia la configuración.
+void systemConfigApply()
+{
+    static int appliedNumberOfAvgSamples = 0;
+    static int appliedEventMaxStorage = 0;
+    int i;
+
+    memcpy( codeSequence, systemConfig.codeSequence, NUMBER_OF_KEYS );
+    systemConfigDerived.overTempLevelRaw = systemConfig.overTempLevel * 0.01 / 3.3;
+    systemConfigDerived.numberOfAvgSamplesInverse = 1.0 / systemConfig.numberOfAvgSamples;
+    systemConfigDerived.blinkingTicksGasAlarm =
+        ( systemConfig.blinkingTimeGasAlarmMs + TIME_INCREMENT_MS - 1 ) / TIME_INCREMENT_MS;
+    systemConfigDerived.blinkingTicksOverTempAlarm =
+        ( systemConfig.blinkingTimeOverTempAlarmMs + TIME_INCREMENT_MS - 1 ) / TIME_INCREMENT_MS;
+    systemConfigDerived.blinkingTicksGasAndOverTempAlarm =
+        ( systemConfig.blinkingTimeGasAndOverTempAlarmMs + TIME_INCREMENT_MS - 1 ) / TIME_INCREMENT_MS;
+
+    //GRUPO: Si cambia la cantidad de muestras se carga el promedio actual en todo el arreglo para no alterarlo.
+    if ( systemConfig.numberOfAvgSamples != appliedNumberOfAvgSamples ) {
+        for ( i = 0; i < NUMBER_OF_AVG_SAMPLES_MAX; i++ ) {
+            lm35ReadingsArray[i] = lm35ReadingsAverage;
+        }
+        lm35SampleIndex = 0;
+        appliedNumberOfAvgSamples = systemConfig.numberOfAvgSamples;
+    }
+
+    //GRUPO: Las posiciones del buffer circular dependen de su tamaño, por eso al cambiarlo se vacía el registro.
+    if ( systemConfig.eventMaxStorage != appliedEventMaxStorage ) {
+        eventLogClear();
+        appliedEventMaxStorage = systemConfig.eventMaxStorage;
+    }
+}
+
+void systemConfigPrint()
+{
+    char str[100];
+
+    sprintf( str, "Configuration version %d%s\r\n", SYSTEM_CONFIG_VERSION,
+             systemConfigFlashAvailable ? "" : " (not persisted)" );
+    uartUsb.write( str, strlen(str) );
+    sprintf( str, "Over temperature level: %d \xB0 C\r\n", systemConfig.overTempLevel );
+    uartUsb.write( str, strlen(str) );
+    sprintf( str, "Number of averaged samples: %d\r\n", systemConfig.numberOfAvgSamples );
+    uartUsb.write( str, strlen(str) );
+    sprintf( str, "Debounce key time: %d ms\r\n", systemConfig.debounceKeyTimeMs );
+    uartUsb.write( str, strlen(str) );
+    sprintf( str, "Blinking time gas alarm: %d ms\r\n", systemConfig.blinkingTimeGasAlarmMs );
+    uartUsb.write( str, strlen(str) );
+    sprintf( str, "Blinking time over temperature alarm: %d ms\r\n",
+             systemConfig.blinkingTimeOverTempAlarmMs );
+    uartUsb.write( str, strlen(str) );
+    sprintf( str, "Blinking time gas and over temperature alarm: %d ms\r\n",
+             systemConfig.blinkingTimeGasAndOverTempAlarmMs );
+    uartUsb.write( str, strlen(str) );
+    sprintf( str, "Event max storage: %d\r\n", systemConfig.eventMaxStorage );
+    uartUsb.write( str, strlen(str) );
+}
+
+/*  GRUPO:  Trama con los valores separados por comas en el orden de systemConfigPrint(). Un campo vacío o una
+            trama más corta conserva los valores actuales. Se rechaza la trama completa si algún valor es inválido.
+*/
+bool systemConfigParseAndWrite( char* str )
+{
+    systemConfig_t newConfig = systemConfig;
+    uint16_t* fieldValues[SYSTEM_CONFIG_NUMBER_OF_FIELDS] = {
+        &newConfig.overTempLevel,
+        &newConfig.numberOfAvgSamples,
+        &newConfig.debounceKeyTimeMs,
+        &newConfig.blinkingTimeGasAlarmMs,
+        &newConfig.blinkingTimeOverTempAlarmMs,
+        &newConfig.blinkingTimeGasAndOverTempAlarmMs,
+        &newConfig.eventMaxStorage,
+    };
+    char* field = str;
+    char* separator;
+    int fieldIndex;
+    int fieldLength;
+    unsigned int invalid = 0;
+
+    for ( fieldIndex = 0; fieldIndex < SYSTEM_CONFIG_NUMBER_OF_FIELDS && field != NULL; fieldIndex++ ) {
+        separator = strchr( field, ',' );
+        if ( separator != NULL ) {
+            *separator = '\0';
+        }
+        fieldLength = strlen( field );
+        if ( fieldLength > 5 ) {
+            return false;
+        }
+        if ( fieldLength > 0 ) {
+            int value = digitsToInt( field, fieldLength, &invalid );
+            invalid |= ( value > 0xFFFF );
+            *fieldValues[fieldIndex] = (uint16_t)value;
+        }
+        field = ( separator != NULL ) ? separator + 1 : NULL;
+    }
+
+    if ( field != NULL || invalid || !systemConfigValidate( &newConfig ) ) {
+        return false;
+    }
+
+    if ( memcmp( &newConfig, &systemConfig, sizeof( systemConfig_t ) ) != 0 ) {
+        systemConfig = newConfig;
+        systemConfigApply();
+        systemConfigSave();
+    }
+    return true;
+}
+
 void eventLogUpdate()
 {
-    systemElementStateUpdate( alarmLastState, alarmState, "ALARM" );
+    systemElementStateUpdate( alarmLastState, alarmState, SYSTEM_ELEMENT_ALARM );
     alarmLastState = alarmState;
 
-    systemElementStateUpdate( gasLastState, !mq2, "GAS_DET" );
-    gasLastState = !mq2;
+    systemElementStateUpdate( gasLastState, inputs.gasDetected, SYSTEM_ELEMENT_GAS_DET );
+    gasLastState = inputs.gasDetected;
 
-    systemElementStateUpdate( tempLastState, overTempDetector, "OVER_TEMP" );
+    systemElementStateUpdate( tempLastState, overTempDetector, SYSTEM_ELEMENT_OVER_TEMP );
     tempLastState = overTempDetector;
 
-    systemElementStateUpdate( ICLastState, incorrectCodeLed, "LED_IC" );
+    systemElementStateUpdate( ICLastState, incorrectCodeLed, SYSTEM_ELEMENT_LED_IC );
     ICLastState = incorrectCodeLed;
 
-    systemElementStateUpdate( SBLastState, systemBlockedLed, "LED_SB" );
+    systemElementStateUpdate( SBLastState, systemBlockedLed, SYSTEM_ELEMENT_LED_SB );
     SBLastState = systemBlockedLed;
 }
 
 void systemElementStateUpdate( bool lastState,
                                bool currentState,
-                               const char* elementName )
+                               systemElement_t element )
 {
     char eventAndStateStr[EVENT_NAME_MAX_LENGTH] = "";
+    systemElementIndex_t* elementIndex = &systemElementIndexes[element];
+    systemEvent_t* event = &arrayOfStoredEvents[eventsIndex];
 
     if ( lastState != currentState ) {
 
-        strcat( eventAndStateStr, elementName );
+        strcat( eventAndStateStr, systemElementNames[element] );
         if ( currentState ) {
             strcat( eventAndStateStr, "_ON" );
         } else {
             strcat( eventAndStateStr, "_OFF" );
         }
 
-        arrayOfStoredEvents[eventsIndex].seconds = time(NULL);
-        strcpy( arrayOfStoredEvents[eventsIndex].typeOfEvent,eventAndStateStr );
-        if ( eventsIndex < EVENT_MAX_STORAGE - 1 ) {
+        event->seconds = time(NULL);
+        event->element = element;
+        event->state = currentState;
+        if ( elementIndex->lastSequence != 0 &&
+             eventsSequence + 1 - elementIndex->lastSequence < ( 1UL << 28 ) ) {
+            event->previousDistance = eventsSequence + 1 - elementIndex->lastSequence;
+        } else {
+            event->previousDistance = 0;
+        }
+
+        //GRUPO: Si el reloj se atrasó, desde este evento empieza un nuevo tramo ordenado en el tiempo.
+        if ( numberOfStoredEvents > 0 && event->seconds < eventsLastSeconds ) {
+            eventsSortedFromSequence = eventsSequence + 1;
+        }
+        eventsLastSeconds = event->seconds;
+
+        //GRUPO: Acumulados del elemento. Se ignoran intervalos negativos por si se atrasó el reloj.
+        if ( currentState ) {
+            elementIndex->numberOfOnTransitions++;
+            elementIndex->onSinceSeconds = event->seconds;
+        } else if ( elementIndex->state && event->seconds > elementIndex->onSinceSeconds ) {
+            elementIndex->accumulatedOnSeconds += event->seconds - elementIndex->onSinceSeconds;
+        }
+        elementIndex->state = currentState;
+
+        eventsSequence++;
+        elementIndex->lastSequence = eventsSequence;
+        if ( numberOfStoredEvents < systemConfig.eventMaxStorage ) {
+            numberOfStoredEvents++;
+        }
+        if ( eventsIndex < systemConfig.eventMaxStorage - 1 ) {
             eventsIndex++;
         } else {
             eventsIndex = 0;
@@ -557,6 +1458,521 @@ void systemElementStateUpdate( bool lastState,
     }
 }
 
+void eventLogClear()
+{
+    int i;
+
+    eventsIndex = 0;
+    numberOfStoredEvents = 0;
+    eventsSequence = 0;
+    eventsSortedFromSequence = 0;
+    eventsLastSeconds = 0;
+    //GRUPO: Los acumulados se reinician junto con el registro; un elemento encendido cuenta desde ahora.
+    for ( i = 0; i < SYSTEM_ELEMENT_NUMBER; i++ ) {
+        systemElementIndexes[i].lastSequence = 0;
+        systemElementIndexes[i].numberOfOnTransitions = 0;
+        systemElementIndexes[i].accumulatedOnSeconds = 0;
+        systemElementIndexes[i].onSinceSeconds = time(NULL);
+    }
+    //GRUPO: Los números de secuencia vuelven a 0, así que los eventos ya no se pueden asociar con la captura.
+    if ( capture != NULL ) {
+        capture->eventLogValid = false;
+    }
+}
+
+void eventPrint( const systemEvent_t* event )
+{
+    char str[100];
+    time_t seconds = event->seconds;
+
+    sprintf ( str, "Event = %s_%s\r\n", systemElementNames[event->element],
+              event->state ? "ON" : "OFF" );
+    uartUsb.write( str , strlen(str) );
+    sprintf ( str, "Date and Time = %s\r\n", ctime(&seconds) );
+    uartUsb.write( str , strlen(str) );
+    uartUsb.write( "\r\n", 2 );
+}
+
+bool eventLogQuery( char* str )
+{
+    char* fields[3] = { NULL, NULL, NULL };
+    char* separator;
+    int fieldIndex;
+    int element = -1;
+    int numberOfEvents;
+    int length;
+    unsigned int invalid = 0;
+    time_t fromSeconds = 0;
+    time_t toSeconds = RTC_EPOCH_MAX;
+    int i;
+
+    switch ( str[0] ) {
+    case 'n':
+    case 'N':
+        length = strlen( &str[1] );
+        if ( length < 1 || length > 3 ) {
+            return false;
+        }
+        numberOfEvents = digitsToInt( &str[1], length, &invalid );
+        if ( invalid ) {
+            return false;
+        }
+        eventLogQueryLast( numberOfEvents );
+        return true;
+
+    case 'f':
+    case 'F':
+        fields[0] = &str[1];
+        for ( fieldIndex = 1; fieldIndex < 3; fieldIndex++ ) {
+            separator = strchr( fields[fieldIndex - 1], ',' );
+            if ( separator == NULL ) {
+                return false;
+            }
+            *separator = '\0';
+            fields[fieldIndex] = separator + 1;
+        }
+        if ( fields[0][0] != '\0' ) {
+            for ( i = 0; i < SYSTEM_ELEMENT_NUMBER && element < 0; i++ ) {
+                if ( strcmp( fields[0], systemElementNames[i] ) == 0 ) {
+                    element = i;
+                }
+            }
+            if ( element < 0 ) {
+                return false;
+            }
+        }
+        if ( fields[1][0] != '\0' && !rtcTimeParse( fields[1], &fromSeconds ) ) {
+            return false;
+        }
+        if ( fields[2][0] != '\0' && !rtcTimeParse( fields[2], &toSeconds ) ) {
+            return false;
+        }
+        eventLogQueryFilter( element, fromSeconds, toSeconds );
+        return true;
+
+    case 's':
+    case 'S':
+        if ( str[1] != '\0' ) {
+            return false;
+        }
+        eventLogQueryStats();
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+void eventLogQueryLast( int numberOfEvents )
+{
+    char str[40];
+    int position = eventsIndex;
+    int i;
+
+    if ( numberOfEvents > numberOfStoredEvents ) {
+        numberOfEvents = numberOfStoredEvents;
+    }
+    for ( i = 0; i < numberOfEvents; i++ ) {
+        position = ( position > 0 ) ? position - 1 : systemConfig.eventMaxStorage - 1;
+        eventPrint( &arrayOfStoredEvents[position] );
+    }
+    sprintf( str, "Events found = %d\r\n", numberOfEvents );
+    uartUsb.write( str, strlen(str) );
+}
+
+/*  GRUPO:  Los eventos se agregan en orden de tiempo salvo cuando se atrasa el reloj ('s', 'd' o 'b'). Desde el
+            último atraso (eventsSortedFromSequence) el registro está ordenado: ahí se busca el final del rango
+            con búsqueda binaria y se corta al pasar el inicio. Los eventos anteriores a ese punto se recorren
+            uno por uno. Con filtro de elemento se recorre solo la cadena de eventos de ese elemento, y solo se
+            corta antes si todo el registro guardado está ordenado.
+*/
+void eventLogQueryFilter( int element, time_t fromSeconds, time_t toSeconds )
+{
+    char str[40];
+    uint32_t oldestSequence = eventsSequence - numberOfStoredEvents;
+    uint32_t sequence;
+    int numberOfEventsFound = 0;
+    int sortedFromIndex = 0;
+    int logicalIndex;
+    const systemEvent_t* event;
+
+    if ( eventsSortedFromSequence > oldestSequence ) {
+        sortedFromIndex = eventsSortedFromSequence - 1 - oldestSequence;
+    }
+
+    if ( element >= 0 ) {
+        sequence = systemElementIndexes[element].lastSequence;
+        while ( sequence > oldestSequence ) {
+            event = &arrayOfStoredEvents[( sequence - 1 ) % systemConfig.eventMaxStorage];
+            if ( event->seconds < fromSeconds && sortedFromIndex == 0 ) {
+                break;
+            }
+            if ( event->seconds >= fromSeconds && event->seconds <= toSeconds ) {
+                eventPrint( event );
+                numberOfEventsFound++;
+            }
+            if ( event->previousDistance == 0 ) {
+                break;
+            }
+            sequence = sequence - event->previousDistance;
+        }
+    } else {
+        if ( toSeconds < RTC_EPOCH_MAX ) {
+            logicalIndex = eventLogLowerBound( toSeconds + 1, sortedFromIndex );
+        } else {
+            logicalIndex = numberOfStoredEvents;
+        }
+        for ( logicalIndex--; logicalIndex >= sortedFromIndex; logicalIndex-- ) {
+            event = &arrayOfStoredEvents[( oldestSequence + logicalIndex ) % systemConfig.eventMaxStorage];
+            if ( event->seconds < fromSeconds ) {
+                break;
+            }
+            eventPrint( event );
+            numberOfEventsFound++;
+        }
+        for ( logicalIndex = sortedFromIndex - 1; logicalIndex >= 0; logicalIndex-- ) {
+            event = &arrayOfStoredEvents[( oldestSequence + logicalIndex ) % systemConfig.eventMaxStorage];
+            if ( event->seconds >= fromSeconds && event->seconds <= toSeconds ) {
+                eventPrint( event );
+                numberOfEventsFound++;
+            }
+        }
+    }
+
+    sprintf( str, "Events found = %d\r\n", numberOfEventsFound );
+    uartUsb.write( str, strlen(str) );
+}
+
+//GRUPO: Primer evento guardado (0 = el más viejo) desde low con seconds >= al valor buscado.
+int eventLogLowerBound( time_t seconds, int low )
+{
+    uint32_t oldestSequence = eventsSequence - numberOfStoredEvents;
+    int high = numberOfStoredEvents;
+    int middle;
+
+    while ( low < high ) {
+        middle = ( low + high ) / 2;
+        if ( arrayOfStoredEvents[( oldestSequence + middle ) % systemConfig.eventMaxStorage].seconds < seconds ) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+void eventLogQueryStats()
+{
+    char str[100];
+    time_t now = time(NULL);
+    time_t onSeconds;
+    int i;
+
+    //GRUPO: Los totales cuentan desde que se vació el registro, aunque el buffer circular ya haya pisado eventos.
+    uartUsb.write( "Totals since the event log was cleared:\r\n", 41 );
+    for ( i = 0; i < SYSTEM_ELEMENT_NUMBER; i++ ) {
+        onSeconds = systemElementIndexes[i].accumulatedOnSeconds;
+        if ( systemElementIndexes[i].state && now > systemElementIndexes[i].onSinceSeconds ) {
+            onSeconds += now - systemElementIndexes[i].onSinceSeconds;
+        }
+        sprintf( str, "%s: %d times ON, %ld seconds ON\r\n", systemElementNames[i],
+                 systemElementIndexes[i].numberOfOnTransitions, (long)onSeconds );
+        uartUsb.write( str, strlen(str) );
+    }
+}
+
+/*  GRUPO:  Eventos con número de secuencia mayor a afterSequence y hasta lastSequence, del más viejo al más
+            nuevo. Si algunos ya fueron pisados en el buffer circular se informa cuántos faltan al principio.
+*/
+void eventLogQuerySequence( uint32_t afterSequence, uint32_t lastSequence )
+{
+    char str[40];
+    uint32_t oldestSequence = eventsSequence - numberOfStoredEvents;
+    uint32_t sequence;
+    int numberOfEventsFound = 0;
+
+    if ( lastSequence > eventsSequence ) {
+        lastSequence = eventsSequence;
+    }
+    if ( afterSequence < oldestSequence ) {
+        sprintf( str, "Events overwritten = %lu\r\n", (unsigned long)( oldestSequence - afterSequence ) );
+        uartUsb.write( str, strlen(str) );
+        afterSequence = oldestSequence;
+    }
+    for ( sequence = afterSequence + 1; sequence <= lastSequence; sequence++ ) {
+        eventPrint( &arrayOfStoredEvents[( sequence - 1 ) % systemConfig.eventMaxStorage] );
+        numberOfEventsFound++;
+    }
+    sprintf( str, "Events found = %d\r\n", numberOfEventsFound );
+    uartUsb.write( str, strlen(str) );
+}
+
+/*  GRUPO:  La captura vive en la SRAM de backup (ver Punto 7-C), así sobrevive a un reset si hay VBAT y se
+            puede volcar con 'x' después de una falsa alarma. Si estaba grabando antes del reset sigue grabando.
+*/
+void captureInit()
+{
+#if defined(BKPSRAM_BASE)
+    __HAL_RCC_PWR_CLK_ENABLE();
+    HAL_PWR_EnableBkUpAccess();
+    __HAL_RCC_BKPSRAM_CLK_ENABLE();
+    HAL_PWREx_EnableBkUpReg();
+    capture = (inputCapture_t*)BKPSRAM_BASE;
+#else
+    capture = &inputCaptureRam;
+#endif
+
+    if ( !captureIsValid() ) {
+        memset( capture, 0, sizeof( inputCapture_t ) );
+        capture->magic = CAPTURE_MAGIC;
+    } else if ( capture->recording ) {
+        //GRUPO: Sigue un tramo nuevo; sus eventos son los del registro que arranca con este reset.
+        captureBlockAdvance();
+        captureSegmentStart = true;
+        capture->eventLogValid = true;
+    } else {
+        //GRUPO: El registro de eventos está en RAM: después del reset ya no es el que acompañaba a la captura.
+        capture->eventLogValid = false;
+    }
+}
+
+//GRUPO: Sin VBAT la SRAM de backup arranca con basura; un largo mayor al bloque haría leer fuera de él y uno
+//       menor al keyframe no tiene el estado completo.
+bool captureIsValid()
+{
+    int i;
+
+    if ( capture->magic != CAPTURE_MAGIC ||
+         capture->currentBlock >= CAPTURE_NUMBER_OF_BLOCKS ||
+         capture->numberOfBlocks > CAPTURE_NUMBER_OF_BLOCKS ) {
+        return false;
+    }
+    for ( i = 0; i < CAPTURE_NUMBER_OF_BLOCKS; i++ ) {
+        if ( capture->blocks[i].length > sizeof( capture->blocks[i].data ) ||
+             ( capture->blocks[i].length > 0 && capture->blocks[i].length < sizeof( captureKeyframe_t ) ) ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void captureStart()
+{
+    capture->recording = true;
+    capture->ticksRecorded = 0;
+    capture->currentBlock = 0;
+    capture->numberOfBlocks = 1;
+    capture->blocks[0].length = 0;
+    capture->eventLogValid = true;
+    capture->lastEventsSequence = eventsSequence;
+    captureSegmentStart = true;
+    captureMaxTickUs = 0;
+    captureTotalUs = 0;
+    captureMeasuredTicks = 0;
+}
+
+uint8_t captureDigitalByte()
+{
+    return ( inputs.gasDetected << 5 ) | ( inputs.alarmTestButtonPressed << 6 ) |
+           ( inputs.keyScanned & 0x1F );
+}
+
+void captureKeyframeWrite( captureBlock_t* block, uint8_t digital )
+{
+    captureKeyframe_t keyframe;
+
+    keyframe.lm35Raw = inputs.lm35Raw;
+    keyframe.digital = digital;
+    keyframe.flags = ( alarmState ? CAPTURE_FLAG_ALARM : 0 ) |
+                     ( overTempDetector ? CAPTURE_FLAG_OVER_TEMP_DETECTOR : 0 ) |
+                     ( gasDetectorState ? CAPTURE_FLAG_GAS_DETECTOR_STATE : 0 ) |
+                     ( overTempDetectorState ? CAPTURE_FLAG_OVER_TEMP_DETECTOR_STATE : 0 ) |
+                     ( incorrectCodeLed ? CAPTURE_FLAG_INCORRECT_CODE_LED : 0 ) |
+                     ( systemBlockedLed ? CAPTURE_FLAG_SYSTEM_BLOCKED_LED : 0 ) |
+                     ( captureSegmentStart ? CAPTURE_FLAG_SEGMENT_START : 0 );
+    keyframe.eventsSequence = eventsSequence;
+    keyframe.lm35ReadingsAverage = lm35ReadingsAverage;
+    keyframe.numberOfIncorrectCodes = numberOfIncorrectCodes;
+    keyframe.matrixKeypadState = matrixKeypadState;
+    keyframe.matrixKeypadLastKeyPressed = matrixKeypadLastKeyPressed;
+    keyframe.matrixKeypadCodeIndex = matrixKeypadCodeIndex;
+    memcpy( keyframe.keyPressed, keyPressed, NUMBER_OF_KEYS );
+    keyframe.accumulatedDebounceMatrixKeypadTime = accumulatedDebounceMatrixKeypadTime;
+    keyframe.reserved = 0;
+
+    memcpy( block->data, &keyframe, sizeof( keyframe ) );
+    block->length = sizeof( keyframe );
+    captureSegmentStart = false;
+}
+
+int captureVarintWrite( uint8_t* data, uint32_t value )
+{
+    int length = 0;
+
+    while ( value >= 0x80 ) {
+        data[length] = ( value & 0x7F ) | 0x80;
+        value = value >> 7;
+        length++;
+    }
+    data[length] = value;
+    return length + 1;
+}
+
+//GRUPO: El bloque nuevo queda vacío; el próximo ciclo grabado escribe su keyframe.
+void captureBlockAdvance()
+{
+    capture->currentBlock = ( capture->currentBlock + 1 ) % CAPTURE_NUMBER_OF_BLOCKS;
+    if ( capture->numberOfBlocks < CAPTURE_NUMBER_OF_BLOCKS ) {
+        capture->numberOfBlocks++;
+    }
+    capture->blocks[capture->currentBlock].length = 0;
+}
+
+void captureUpdate()
+{
+    captureBlock_t* block;
+    uint32_t startUs;
+    uint32_t elapsedUs;
+    uint8_t digital;
+    int32_t delta;
+    uint32_t zigzag;
+
+    if ( !capture->recording ) {
+        return;
+    }
+
+    startUs = us_ticker_read();
+
+    block = &capture->blocks[capture->currentBlock];
+    if ( block->length + CAPTURE_RECORD_MAX_SIZE > (int)sizeof( block->data ) ) {
+        captureBlockAdvance();
+        block = &capture->blocks[capture->currentBlock];
+    }
+
+    digital = captureDigitalByte();
+    if ( block->length == 0 ) {
+        captureKeyframeWrite( block, digital );
+    } else {
+        delta = (int32_t)inputs.lm35Raw - (int32_t)captureLastLm35Raw;
+        zigzag = ( (uint32_t)delta << 1 ) ^ (uint32_t)( delta >> 31 );
+        if ( digital == captureLastDigital && zigzag < 0x80 ) {
+            block->data[block->length] = zigzag;
+            block->length++;
+        } else {
+            block->data[block->length] = 0x80 | digital;
+            block->length++;
+            block->length += captureVarintWrite( &block->data[block->length], zigzag );
+        }
+    }
+    captureLastLm35Raw = inputs.lm35Raw;
+    captureLastDigital = digital;
+    capture->ticksRecorded++;
+    capture->lastEventsSequence = eventsSequence;
+
+    elapsedUs = us_ticker_read() - startUs;
+    if ( elapsedUs > captureMaxTickUs ) {
+        captureMaxTickUs = elapsedUs;
+    }
+    captureTotalUs += elapsedUs;
+    captureMeasuredTicks++;
+}
+
+//GRUPO: Posición en el buffer del bloque vivo número i, contando desde el más viejo.
+int captureBlockIndex( int i )
+{
+    return ( capture->currentBlock + CAPTURE_NUMBER_OF_BLOCKS + 1 - capture->numberOfBlocks + i ) %
+           CAPTURE_NUMBER_OF_BLOCKS;
+}
+
+//GRUPO: Bloque vivo desde el que se reproduce: el último que empieza un tramo o, si no hay, el más viejo.
+int captureReplayStartBlock()
+{
+    const captureBlock_t* block;
+    captureKeyframe_t keyframe;
+    int startBlock = -1;
+    int i;
+
+    for ( i = 0; i < capture->numberOfBlocks; i++ ) {
+        block = &capture->blocks[captureBlockIndex( i )];
+        if ( block->length == 0 ) {
+            continue;
+        }
+        memcpy( &keyframe, block->data, sizeof( keyframe ) );
+        if ( startBlock < 0 || ( keyframe.flags & CAPTURE_FLAG_SEGMENT_START ) ) {
+            startBlock = i;
+        }
+    }
+    return startBlock;
+}
+
+void captureStatusPrint()
+{
+    char str[100];
+    int bytesUsed = 0;
+    int i;
+
+    //GRUPO: Solo los bloques vivos; los demás pueden tener largos de una captura anterior.
+    for ( i = 0; i < capture->numberOfBlocks; i++ ) {
+        bytesUsed += capture->blocks[captureBlockIndex( i )].length;
+    }
+
+    sprintf( str, "Capture %s: %lu ticks, %d blocks, %d bytes\r\n",
+             capture->recording ? "on" : "off", (unsigned long)capture->ticksRecorded,
+             capture->numberOfBlocks, bytesUsed );
+    uartUsb.write( str, strlen(str) );
+    sprintf( str, "Capture cost per tick: %lu us average, %lu us max\r\n",
+             (unsigned long)( captureMeasuredTicks ? captureTotalUs / captureMeasuredTicks : 0 ),
+             (unsigned long)captureMaxTickUs );
+    uartUsb.write( str, strlen(str) );
+}
+
+/*  GRUPO:  El volcado lleva todo lo que necesita test/replay: la configuración (en el formato de 'w', sin el
+            código), los bloques en hexadecimal y los eventos que registró el equipo durante la captura.
+*/
+void captureDump()
+{
+    char str[60];
+    int i;
+    int j;
+    const captureBlock_t* block;
+
+    captureStatusPrint();
+    sprintf( str, "Capture config: %d,%d,%d,%d,%d,%d,%d\r\n", systemConfig.overTempLevel,
+             systemConfig.numberOfAvgSamples, systemConfig.debounceKeyTimeMs,
+             systemConfig.blinkingTimeGasAlarmMs, systemConfig.blinkingTimeOverTempAlarmMs,
+             systemConfig.blinkingTimeGasAndOverTempAlarmMs, systemConfig.eventMaxStorage );
+    uartUsb.write( str, strlen(str) );
+    for ( i = 0; i < capture->numberOfBlocks; i++ ) {
+        block = &capture->blocks[captureBlockIndex( i )];
+        for ( j = 0; j < block->length; j++ ) {
+            sprintf( str, "%02X", block->data[j] );
+            uartUsb.write( str, 2 );
+        }
+        uartUsb.write( "\r\n", 2 );
+    }
+    captureEventsPrint();
+}
+
+//GRUPO: Eventos desde el keyframe donde arranca el replay hasta el último ciclo grabado.
+void captureEventsPrint()
+{
+    captureKeyframe_t keyframe;
+    char str[60];
+    int startBlock = captureReplayStartBlock();
+
+    if ( startBlock < 0 ) {
+        return;
+    }
+    memcpy( &keyframe, capture->blocks[captureBlockIndex( startBlock )].data, sizeof( keyframe ) );
+    if ( !capture->eventLogValid || keyframe.eventsSequence > eventsSequence ) {
+        uartUsb.write( "Capture events not available\r\n", 30 );
+        return;
+    }
+    sprintf( str, "Capture events after sequence %lu\r\n", (unsigned long)keyframe.eventsSequence );
+    uartUsb.write( str, strlen(str) );
+    eventLogQuerySequence( keyframe.eventsSequence, capture->lastEventsSequence );
+}
+
 float analogReadingScaledWithTheLM35Formula( float analogReading )
 {
     return ( analogReading * 3.3 / 0.01 );
@@ -569,7 +1985,7 @@ float celsiusToFahrenheit( float tempInCelsiusDegrees )
 void lm35ReadingsArrayInit()
 {
     int i;
-    for( i=0; i<NUMBER_OF_AVG_SAMPLES ; i++ ) {
+    for( i=0; i<NUMBER_OF_AVG_SAMPLES_MAX ; i++ ) {
         lm35ReadingsArray[i] = 0;
     }
 }
@@ -599,10 +2015,12 @@ char matrixKeypadScan()
 
         for( col=0; col<KEYPAD_NUMBER_OF_COLS; col++ ) {
             if( keypadColPins[col] == OFF ) {
+                inputs.keyScanned = row*KEYPAD_NUMBER_OF_ROWS + col + 1;
                 return matrixKeypadIndexToCharArray[row*KEYPAD_NUMBER_OF_ROWS + col];
             }
         }
     }
+    inputs.keyScanned = 0;
     return '\0';
 }
 
@@ -624,7 +2042,7 @@ char matrixKeypadUpdate()
 
     case MATRIX_KEYPAD_DEBOUNCE:
         if( accumulatedDebounceMatrixKeypadTime >=
-            DEBOUNCE_KEY_TIME_MS ) {    
+            systemConfig.debounceKeyTimeMs ) {    
             keyDetected = matrixKeypadScan();
             if( keyDetected == matrixKeypadLastKeyPressed ) {
                 matrixKeypadState = MATRIX_KEYPAD_KEY_HOLD_PRESSED;
@@ -0,0 +1,218 @@
+//=====[Libraries]=============================================================
+
+#include "firmware.h"
+
+//=====[Declaration of public defines]=========================================
+
+#define CONFIG_V1_SIZE    28
+
+//=====[Implementations of public functions]===================================
+
+static uint8_t* configSector()
+{
+    return &simulatedFlash[systemConfigFlashAddress - SIMULATED_FLASH_START];
+}
+
+//GRUPO: Escribe un bloque crudo en el registro, con el CRC correcto o corrompido.
+static void configBlockWrite( int slot, const void* fields, int size, uint16_t version,
+                              uint32_t magic, bool goodCrc )
+{
+    uint8_t block[SYSTEM_CONFIG_STORAGE_SIZE];
+    systemConfigHeader_t header;
+
+    memset( block, 0xFF, sizeof( block ) );
+    memcpy( block, fields, size );
+    header.magic = magic;
+    header.version = version;
+    header.size = size;
+    header.crc = systemConfigCrc( block, size ) ^ ( goodCrc ? 0 : 1 );
+    memcpy( block, &header, sizeof( header ) );
+    memcpy( configSector() + slot * SYSTEM_CONFIG_STORAGE_SIZE, block, sizeof( block ) );
+}
+
+static void configReload()
+{
+    systemConfigDefaults( &systemConfig );
+    systemConfigInit();
+}
+
+static void configWrite( const char* frame )
+{
+    char line[UART_LINE_MAX_LENGTH];
+
+    strcpy( line, frame );
+    CHECK( systemConfigParseAndWrite( line ) );
+}
+
+static void blankFlashTest()
+{
+    firmwareInit();
+    CHECK( systemConfig.overTempLevel == OVER_TEMP_LEVEL );
+    CHECK( memcmp( codeSequence, "1805", NUMBER_OF_KEYS ) == 0 );
+    CHECK( systemConfigNextOffset == 0 );
+}
+
+static void persistTest()
+{
+    char line[UART_LINE_MAX_LENGTH];
+
+    firmwareInit();
+    configWrite( "60,,,,,,50" );
+    strcpy( line, ",4321," );
+    CHECK( bulkConfigParseAndApply( line ) );
+
+    configReload();
+    CHECK( systemConfig.overTempLevel == 60 );
+    CHECK( systemConfig.eventMaxStorage == 50 );
+    CHECK( memcmp( codeSequence, "4321", NUMBER_OF_KEYS ) == 0 );
+    CHECK( systemConfigNextOffset == 2 * SYSTEM_CONFIG_STORAGE_SIZE );
+}
+
+//GRUPO: Los guardados se agregan al registro y el sector se borra una sola vez, cuando se llena.
+static void appendTest()
+{
+    int slots;
+    int i;
+    char frame[UART_LINE_MAX_LENGTH];
+
+    firmwareInit();
+    simulatedFlashErases = 0;
+    slots = systemConfigSectorSize / SYSTEM_CONFIG_STORAGE_SIZE;
+    for ( i = 0; i < slots; i++ ) {
+        sprintf( frame, "%d", 10 + i % 100 );
+        configWrite( frame );
+    }
+    CHECK( simulatedFlashErases == 0 );
+    CHECK( systemConfigNextOffset == systemConfigSectorSize );
+
+    configWrite( "120" );
+    CHECK( simulatedFlashErases == 1 );
+    CHECK( systemConfigNextOffset == SYSTEM_CONFIG_STORAGE_SIZE );
+
+    configReload();
+    CHECK( systemConfig.overTempLevel == 120 );
+}
+
+static void badMagicTest()
+{
+    systemConfig_t config;
+
+    firmwareInit();
+    systemConfigDefaults( &config );
+    config.overTempLevel = 70;
+    configBlockWrite( 0, &config, sizeof( config ), SYSTEM_CONFIG_VERSION, 0x12345678, true );
+    configReload();
+    CHECK( systemConfig.overTempLevel == OVER_TEMP_LEVEL );
+    CHECK( systemConfigNextOffset == SYSTEM_CONFIG_STORAGE_SIZE );
+}
+
+//GRUPO: Un bloque con CRC incorrecto (escritura cortada) no pisa al último bloque correcto.
+static void badCrcTest()
+{
+    systemConfig_t config;
+
+    firmwareInit();
+    systemConfigDefaults( &config );
+    config.overTempLevel = 70;
+    configBlockWrite( 0, &config, sizeof( config ), SYSTEM_CONFIG_VERSION, SYSTEM_CONFIG_MAGIC, true );
+    config.overTempLevel = 80;
+    configBlockWrite( 1, &config, sizeof( config ), SYSTEM_CONFIG_VERSION, SYSTEM_CONFIG_MAGIC, false );
+    configReload();
+    CHECK( systemConfig.overTempLevel == 70 );
+    CHECK( systemConfigNextOffset == 2 * SYSTEM_CONFIG_STORAGE_SIZE );
+}
+
+//GRUPO: Un bloque de la versión 1 no tiene código: se conserva lo demás y se guarda con el formato actual.
+static void olderVersionTest()
+{
+    systemConfig_t config;
+    systemConfigHeader_t header;
+
+    firmwareInit();
+    systemConfigDefaults( &config );
+    config.overTempLevel = 70;
+    config.numberOfAvgSamples = 10;
+    memcpy( config.codeSequence, "9999", NUMBER_OF_KEYS );
+    configBlockWrite( 0, &config, CONFIG_V1_SIZE, 1, SYSTEM_CONFIG_MAGIC, true );
+    configReload();
+    CHECK( systemConfig.overTempLevel == 70 );
+    CHECK( systemConfig.numberOfAvgSamples == 10 );
+    CHECK( memcmp( codeSequence, "1805", NUMBER_OF_KEYS ) == 0 );
+
+    memcpy( &header, configSector() + SYSTEM_CONFIG_STORAGE_SIZE, sizeof( header ) );
+    CHECK( header.version == SYSTEM_CONFIG_VERSION );
+    CHECK( header.size == sizeof( systemConfig_t ) );
+    CHECK( systemConfigNextOffset == 2 * SYSTEM_CONFIG_STORAGE_SIZE );
+}
+
+//GRUPO: Un bloque de una versión posterior trae campos desconocidos al final: se copian solo los conocidos.
+static void newerVersionTest()
+{
+    uint8_t fields[sizeof( systemConfig_t ) + 8];
+    systemConfig_t config;
+    systemConfigHeader_t header;
+
+    firmwareInit();
+    systemConfigDefaults( &config );
+    config.debounceKeyTimeMs = 80;
+    memcpy( config.codeSequence, "2468", NUMBER_OF_KEYS );
+    memset( fields, 0xAB, sizeof( fields ) );
+    memcpy( fields, &config, sizeof( config ) );
+    configBlockWrite( 0, fields, sizeof( fields ), SYSTEM_CONFIG_VERSION + 1, SYSTEM_CONFIG_MAGIC, true );
+    configReload();
+    CHECK( systemConfig.debounceKeyTimeMs == 80 );
+    CHECK( memcmp( codeSequence, "2468", NUMBER_OF_KEYS ) == 0 );
+
+    memcpy( &header, configSector() + SYSTEM_CONFIG_STORAGE_SIZE, sizeof( header ) );
+    CHECK( header.version == SYSTEM_CONFIG_VERSION );
+    CHECK( header.size == sizeof( systemConfig_t ) );
+}
+
+static void outOfRangeTest()
+{
+    systemConfig_t config;
+
+    firmwareInit();
+    systemConfigDefaults( &config );
+    config.overTempLevel = OVER_TEMP_LEVEL_MAX + 1;
+    config.numberOfAvgSamples = 0;
+    config.eventMaxStorage = EVENT_MAX_STORAGE_MAX + 1;
+    config.blinkingTimeGasAlarmMs = 2000;
+    memcpy( config.codeSequence, "12a4", NUMBER_OF_KEYS );
+    configBlockWrite( 0, &config, sizeof( config ), SYSTEM_CONFIG_VERSION, SYSTEM_CONFIG_MAGIC, true );
+    configReload();
+    CHECK( systemConfig.overTempLevel == OVER_TEMP_LEVEL );
+    CHECK( systemConfig.numberOfAvgSamples == NUMBER_OF_AVG_SAMPLES );
+    CHECK( systemConfig.eventMaxStorage == EVENT_MAX_STORAGE );
+    CHECK( systemConfig.blinkingTimeGasAlarmMs == 2000 );
+    CHECK( systemConfigDerived.blinkingTicksGasAlarm == 200 );
+    CHECK( memcmp( codeSequence, "1805", NUMBER_OF_KEYS ) == 0 );
+}
+
+static void invalidWriteTest()
+{
+    char line[UART_LINE_MAX_LENGTH];
+
+    firmwareInit();
+    strcpy( line, "151" );
+    CHECK( !systemConfigParseAndWrite( line ) );
+    strcpy( line, "1,2,3,4,5,6,7,8" );
+    CHECK( !systemConfigParseAndWrite( line ) );
+    strcpy( line, ",,,5" );
+    CHECK( !systemConfigParseAndWrite( line ) );
+    CHECK( systemConfigNextOffset == 0 );
+}
+
+int main()
+{
+    blankFlashTest();
+    persistTest();
+    appendTest();
+    badMagicTest();
+    badCrcTest();
+    olderVersionTest();
+    newerVersionTest();
+    outOfRangeTest();
+    invalidWriteTest();
+    return checkResult( "config_test" );
+}
@@ -0,0 +1,192 @@
+//=====[Libraries]=============================================================
+
+#include "firmware.h"
+
+#include <random>
+
+//=====[Declaration of public defines]=========================================
+
+#define BENCHMARK_STORED_EVENTS     10000
+#define BENCHMARK_APPENDED_EVENTS   25000
+#define BENCHMARK_REPETITIONS         200
+
+//=====[Declaration and initialization of public global variables]=============
+
+static bool benchmarkStates[SYSTEM_ELEMENT_NUMBER];
+static int benchmarkOnTransitions[SYSTEM_ELEMENT_NUMBER];
+static mt19937 benchmarkRandom( 1805 );
+
+//=====[Implementations of public functions]===================================
+
+static void benchmarkAppend( int numberOfEvents )
+{
+    int element;
+    int i;
+
+    for ( i = 0; i < numberOfEvents; i++ ) {
+        element = benchmarkRandom() % SYSTEM_ELEMENT_NUMBER;
+        simulatedSeconds += benchmarkRandom() % 4;
+        systemElementStateUpdate( benchmarkStates[element], !benchmarkStates[element],
+                                  (systemElement_t)element );
+        benchmarkStates[element] = !benchmarkStates[element];
+        if ( benchmarkStates[element] ) {
+            benchmarkOnTransitions[element]++;
+        }
+    }
+    simulatedUartTx.clear();
+}
+
+//GRUPO: Recorre todo el registro guardado, como lo haría una consulta sin índice.
+static int bruteForceCount( int element, time_t fromSeconds, time_t toSeconds )
+{
+    uint32_t oldestSequence = eventsSequence - numberOfStoredEvents;
+    const systemEvent_t* event;
+    int count = 0;
+    int i;
+
+    for ( i = 0; i < numberOfStoredEvents; i++ ) {
+        event = &arrayOfStoredEvents[( oldestSequence + i ) % systemConfig.eventMaxStorage];
+        if ( ( element < 0 || (int)event->element == element ) &&
+             event->seconds >= fromSeconds && event->seconds <= toSeconds ) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static int queryCount( const char* query )
+{
+    char line[UART_LINE_MAX_LENGTH];
+    size_t position;
+    int count = -1;
+
+    simulatedUartTx.clear();
+    strcpy( line, query );
+    CHECK( eventLogQuery( line ) );
+    position = simulatedUartTx.rfind( "Events found = " );
+    if ( position != string::npos ) {
+        count = atoi( simulatedUartTx.c_str() + position + 15 );
+    }
+    return count;
+}
+
+static double queryMicroseconds( const char* query )
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    int i;
+
+    for ( i = 0; i < BENCHMARK_REPETITIONS; i++ ) {
+        queryCount( query );
+    }
+    return chrono::duration<double, micro>( chrono::steady_clock::now() - start ).count() /
+           BENCHMARK_REPETITIONS;
+}
+
+static double bruteForceMicroseconds( int element, time_t fromSeconds, time_t toSeconds )
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    volatile int count = 0;
+    int i;
+
+    for ( i = 0; i < BENCHMARK_REPETITIONS; i++ ) {
+        count = count + bruteForceCount( element, fromSeconds, toSeconds );
+    }
+    return chrono::duration<double, micro>( chrono::steady_clock::now() - start ).count() /
+           BENCHMARK_REPETITIONS;
+}
+
+static void rangeCheck( int element, time_t fromSeconds, time_t toSeconds )
+{
+    char query[UART_LINE_MAX_LENGTH];
+
+    sprintf( query, "f%s,%ld,%ld", element < 0 ? "" : systemElementNames[element],
+             (long)fromSeconds, (long)toSeconds );
+    CHECK( queryCount( query ) == bruteForceCount( element, fromSeconds, toSeconds ) );
+}
+
+//GRUPO: La consulta imprime cada evento encontrado; el recorrido completo solo los cuenta.
+static void benchmarkReport( const char* name, int element, time_t fromSeconds, time_t toSeconds )
+{
+    char query[UART_LINE_MAX_LENGTH];
+
+    sprintf( query, "f%s,%ld,%ld", element < 0 ? "" : systemElementNames[element],
+             (long)fromSeconds, (long)toSeconds );
+    printf( "  %-24s %5d found %8.2f us/query (full scan %6.2f us)\n", name, queryCount( query ),
+            queryMicroseconds( query ), bruteForceMicroseconds( element, fromSeconds, toSeconds ) );
+}
+
+int main()
+{
+    char line[UART_LINE_MAX_LENGTH];
+    time_t newestSeconds;
+    time_t fromSeconds;
+    int i;
+
+    firmwareInit();
+    simulatedSeconds = 1760616000;
+    sprintf( line, ",,,,,,%d", BENCHMARK_STORED_EVENTS );
+    CHECK( systemConfigParseAndWrite( line ) );
+    for ( i = 0; i < SYSTEM_ELEMENT_NUMBER; i++ ) {
+        benchmarkStates[i] = systemElementIndexes[i].state;
+    }
+
+    benchmarkAppend( BENCHMARK_APPENDED_EVENTS );
+    CHECK( numberOfStoredEvents == BENCHMARK_STORED_EVENTS );
+
+    newestSeconds = simulatedSeconds;
+    fromSeconds = newestSeconds - 600;
+
+    CHECK( queryCount( "n100" ) == 100 );
+    for ( i = 0; i < SYSTEM_ELEMENT_NUMBER; i++ ) {
+        CHECK( systemElementIndexes[i].numberOfOnTransitions == benchmarkOnTransitions[i] );
+        rangeCheck( i, fromSeconds, newestSeconds );
+        rangeCheck( i, 0, RTC_EPOCH_MAX );
+    }
+    rangeCheck( -1, fromSeconds, newestSeconds );
+    rangeCheck( -1, fromSeconds - 3000, fromSeconds - 2000 );
+
+    printf( "event_log_benchmark: %d events stored (%d bytes), %d appended\n",
+            numberOfStoredEvents, (int)sizeof( arrayOfStoredEvents ), BENCHMARK_APPENDED_EVENTS );
+    printf( "  %-24s %5d found %8.2f us/query\n", "last 100 events", queryCount( "n100" ),
+            queryMicroseconds( "n100" ) );
+    benchmarkReport( "ALARM, last 10 minutes", SYSTEM_ELEMENT_ALARM, fromSeconds, newestSeconds );
+    benchmarkReport( "all, last 10 minutes", -1, fromSeconds, newestSeconds );
+    benchmarkReport( "ALARM, 10 s window", SYSTEM_ELEMENT_ALARM, fromSeconds - 2000, fromSeconds - 1990 );
+    benchmarkReport( "all, 10 s window", -1, fromSeconds - 2000, fromSeconds - 1990 );
+    printf( "  %-24s %8.2f us/query\n", "totals per element", queryMicroseconds( "s" ) );
+
+    //GRUPO: Con el reloj atrasado los rangos tienen que seguir encontrando los eventos de los dos tramos.
+    simulatedSeconds = newestSeconds - 5000;
+    benchmarkAppend( 300 );
+    CHECK( eventsSortedFromSequence != 0 );
+    rangeCheck( -1, newestSeconds - 5000, newestSeconds );
+    rangeCheck( -1, fromSeconds, newestSeconds );
+    for ( i = 0; i < SYSTEM_ELEMENT_NUMBER; i++ ) {
+        rangeCheck( i, newestSeconds - 5000, newestSeconds );
+    }
+
+    //GRUPO: Al vaciar el registro se reinician también los totales.
+    eventLogClear();
+    simulatedUartTx.clear();
+    strcpy( line, "s" );
+    CHECK( eventLogQuery( line ) );
+    CHECK( simulatedUartTx.find( "ALARM: 0 times ON" ) != string::npos );
+    CHECK( queryCount( "n10" ) == 0 );
+
+    //GRUPO: Alarma encendida desde el arranque con el RTC en 1970; al aprovisionar la fecha el salto no se suma.
+    simulatedSeconds = 100;
+    eventLogClear();
+    systemElementStateUpdate( OFF, ON, SYSTEM_ELEMENT_ALARM );
+    simulatedSeconds += 50;
+    strcpy( line, "2026-10-16T12:00:00" );
+    uartLineDispatch( 'd', line, true );
+    simulatedSeconds += 10;
+    simulatedUartTx.clear();
+    strcpy( line, "s" );
+    CHECK( eventLogQuery( line ) );
+    CHECK( simulatedUartTx.find( "ALARM: 1 times ON, 60 seconds ON" ) != string::npos );
+    systemElementStateUpdate( ON, OFF, SYSTEM_ELEMENT_ALARM );
+    CHECK( systemElementIndexes[SYSTEM_ELEMENT_ALARM].accumulatedOnSeconds == 60 );
+
+    return checkResult( "event_log_benchmark" );
+}
@@ -0,0 +1,106 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _FIRMWARE_H_
+#define _FIRMWARE_H_
+
+/*  GRUPO:  Compila main.cpp en la PC contra el HAL simulado de stub/. El main() del firmware pasa a llamarse
+            firmwareMain() para que cada test tenga el suyo.
+*/
+
+//=====[Libraries]=============================================================
+
+#define main firmwareMain
+#include "../main.cpp"
+#undef main
+
+//=====[Declaration of public defines]=========================================
+
+#define CHECK( condition )                                                    \
+    do {                                                                      \
+        if ( !( condition ) ) {                                               \
+            fprintf( stderr, "%s:%d: CHECK failed: %s\n",                     \
+                     __FILE__, __LINE__, #condition );                        \
+            checkFailures++;                                                  \
+        }                                                                     \
+    } while ( 0 )
+
+//=====[Declaration and initialization of public global variables]=============
+
+static int checkFailures = 0;
+static int simulatedTicks = 0;
+
+//=====[Implementations of public functions]===================================
+
+//GRUPO: Deja la alarma, el teclado y el registro de eventos como después de un reset, para que varias corridas
+//       en el mismo proceso no dependan de la anterior.
+static inline void firmwareReset()
+{
+    alarmState = OFF;
+    overTempDetector = OFF;
+    gasDetectorState = OFF;
+    overTempDetectorState = OFF;
+    numberOfIncorrectCodes = 0;
+    numberOfHashKeyReleasedEvents = 0;
+    accumulatedTicksAlarm = 0;
+    matrixKeypadCodeIndex = 0;
+    matrixKeypadLastKeyPressed = '\0';
+    accumulatedDebounceMatrixKeypadTime = 0;
+    lm35SampleIndex = 0;
+
+    alarmLastState = OFF;
+    gasLastState = OFF;
+    tempLastState = OFF;
+    ICLastState = OFF;
+    SBLastState = OFF;
+    eventLogClear();
+    memset( systemElementIndexes, 0, sizeof( systemElementIndexes ) );
+    memset( &inputs, 0, sizeof( inputs ) );
+}
+
+//GRUPO: Mismo orden que inputsInit()/outputsInit() en el firmware, con la hora en UTC.
+static inline void firmwareInit()
+{
+    setenv( "TZ", "UTC", 1 );
+    tzset();
+    memset( simulatedFlash, 0xFF, sizeof( simulatedFlash ) );
+    simulatedPinValue[PE_12] = 1;
+    simulatedPinValue[BUTTON1] = 0;
+    simulatedAdcValue = 0;
+    simulatedKey = -1;
+    simulatedUartRx.clear();
+    simulatedUartRxIndex = 0;
+    uartLineCommand = '\0';
+    firmwareReset();
+    inputsInit();
+    outputsInit();
+    simulatedUartTx.clear();
+}
+
+//GRUPO: Un ciclo del while de main(); el reloj simulado avanza un segundo cada 1000 ms de ciclos.
+static inline void firmwareTick()
+{
+    inputsUpdate();
+    alarmActivationUpdate();
+    alarmDeactivationUpdate();
+    uartTask();
+    eventLogUpdate();
+    captureUpdate();
+    simulatedTicks++;
+    if ( simulatedTicks % ( 1000 / TIME_INCREMENT_MS ) == 0 ) {
+        simulatedSeconds++;
+    }
+}
+
+static inline int checkResult( const char* testName )
+{
+    if ( checkFailures == 0 ) {
+        printf( "%s: OK\n", testName );
+        return 0;
+    }
+    printf( "%s: %d checks failed\n", testName, checkFailures );
+    return 1;
+}
+
+//=====[#include guards - end]=================================================
+
+#endif // _FIRMWARE_H_
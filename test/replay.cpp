@@ -0,0 +1,65 @@
+//=====[Libraries]=============================================================
+
+#include "replay.h"
+
+#include <fstream>
+#include <iterator>
+
+/*  GRUPO:  Herramienta para reproducir una falsa alarma en la PC:
+                ./replay captura.txt          reproduce la salida de 'x' y la compara con los eventos del equipo
+                ./replay captura.txt 4321     lo mismo, si el código del equipo no es el de fábrica
+            Devuelve 0 si los registros coinciden, 1 si difieren y 2 si el volcado no se puede leer.
+*/
+
+//=====[Implementations of public functions]===================================
+
+static bool fileRead( const char* path, string* content )
+{
+    ifstream file( path, ios::binary );
+
+    if ( !file ) {
+        fprintf( stderr, "replay: cannot open %s\n", path );
+        return false;
+    }
+    content->assign( istreambuf_iterator<char>( file ), istreambuf_iterator<char>() );
+    return true;
+}
+
+int main( int argc, char* argv[] )
+{
+    replayCapture_t replay;
+    vector<string> replayed;
+    string dump;
+    size_t startTick;
+    size_t i;
+
+    if ( argc < 2 || argc > 3 || ( argc == 3 && strlen( argv[2] ) != NUMBER_OF_KEYS ) ) {
+        fprintf( stderr, "usage: %s <capture dump> [<%d digit code>]\n", argv[0], NUMBER_OF_KEYS );
+        return 2;
+    }
+    if ( !fileRead( argv[1], &dump ) ) {
+        return 2;
+    }
+    if ( !replayDumpParse( dump, &replay ) ) {
+        fprintf( stderr, "replay: %s is not a valid capture dump\n", argv[1] );
+        return 2;
+    }
+
+    startTick = replayStartTick( replay );
+    replayed = replayRun( replay, argc == 3 ? argv[2] : NULL );
+    printf( "%zu ticks decoded, replayed from tick %zu, %zu events\n", replay.ticks.size(), startTick,
+            replayed.size() );
+    for ( i = 0; i < replayed.size(); i++ ) {
+        printf( "%s%s\n", REPLAY_EVENT_PREFIX, replayed[i].c_str() );
+    }
+
+    if ( !replay.eventsAvailable ) {
+        printf( "the dump has no events from the unit to compare with\n" );
+        return 0;
+    }
+    if ( !replayCaptureCompare( replay, replayed ) ) {
+        return 1;
+    }
+    printf( "event logs match\n" );
+    return 0;
+}
@@ -0,0 +1,309 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _REPLAY_H_
+#define _REPLAY_H_
+
+/*  GRUPO:  Reproduce en la PC una captura volcada con 'x'. El replay arranca del keyframe del bloque más viejo
+            que quedó (o del último tramo, si el equipo se reseteó mientras grababa) con el estado del firmware
+            que guarda ese keyframe. Desde ahí cada ciclo grabado se carga en el HAL simulado (ADC, MQ-2, botón
+            y tecla) y se corre un ciclo completo del firmware, así alarmActivationUpdate() y
+            matrixKeypadUpdate() procesan las mismas entradas que en el equipo. El registro que resulta se
+            compara con los eventos que el equipo registró después de ese keyframe, que vienen en el volcado.
+*/
+
+//=====[Libraries]=============================================================
+
+#include "firmware.h"
+
+#include <cctype>
+#include <sstream>
+
+//=====[Declaration of public defines]=========================================
+
+#define REPLAY_EVENT_PREFIX         "Event = "
+#define REPLAY_CONFIG_PREFIX        "Capture config: "
+#define REPLAY_EVENTS_PREFIX        "Capture events after sequence "
+#define REPLAY_OVERWRITTEN_PREFIX   "Events overwritten = "
+
+//=====[Declaration of public data types]======================================
+
+//GRUPO: Un ciclo grabado. El primero de cada bloque trae además el keyframe con el estado del firmware.
+typedef struct replayTick {
+    systemInputs_t inputs;
+    bool hasKeyframe;
+    captureKeyframe_t keyframe;
+} replayTick_t;
+
+typedef struct replayCapture {
+    string config;
+    vector<replayTick_t> ticks;
+    bool eventsAvailable;
+    int eventsOverwritten;
+    vector<string> events;
+} replayCapture_t;
+
+//=====[Implementations of public functions]===================================
+
+static inline bool replayPrefixIs( const string& line, const char* prefix )
+{
+    return line.compare( 0, strlen( prefix ), prefix ) == 0;
+}
+
+static inline bool replayIsHexLine( const string& line )
+{
+    size_t i;
+
+    if ( line.empty() ) {
+        return false;
+    }
+    for ( i = 0; i < line.size(); i++ ) {
+        if ( !isxdigit( (unsigned char)line[i] ) ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static inline void replayInputsFromDigital( systemInputs_t* inputs, uint8_t digital )
+{
+    inputs->gasDetected = ( digital >> 5 ) & 1;
+    inputs->alarmTestButtonPressed = ( digital >> 6 ) & 1;
+    inputs->keyScanned = digital & 0x1F;
+}
+
+//GRUPO: Inversa de captureUpdate(). Un bloque truncado o con un varint cortado se rechaza entero.
+static inline bool replayBlockDecode( const vector<uint8_t>& block, vector<replayTick_t>* ticks )
+{
+    replayTick_t tick;
+    uint8_t header;
+    uint32_t zigzag;
+    int32_t delta;
+    size_t offset;
+    int shift;
+
+    if ( block.size() < sizeof( captureKeyframe_t ) ) {
+        return false;
+    }
+    memcpy( &tick.keyframe, block.data(), sizeof( captureKeyframe_t ) );
+    tick.hasKeyframe = true;
+    tick.inputs.lm35Raw = tick.keyframe.lm35Raw;
+    replayInputsFromDigital( &tick.inputs, tick.keyframe.digital );
+    offset = sizeof( captureKeyframe_t );
+
+    while ( true ) {
+        ticks->push_back( tick );
+        tick.hasKeyframe = false;
+        if ( offset >= block.size() ) {
+            return true;
+        }
+
+        header = block[offset++];
+        if ( header & 0x80 ) {
+            replayInputsFromDigital( &tick.inputs, header & 0x7F );
+            zigzag = 0;
+            shift = 0;
+            do {
+                if ( offset >= block.size() || shift > 28 ) {
+                    return false;
+                }
+                zigzag |= (uint32_t)( block[offset] & 0x7F ) << shift;
+                shift += 7;
+            } while ( block[offset++] & 0x80 );
+        } else {
+            zigzag = header;
+        }
+        delta = (int32_t)( zigzag >> 1 ) ^ -(int32_t)( zigzag & 1 );
+        tick.inputs.lm35Raw = tick.inputs.lm35Raw + delta;
+    }
+}
+
+/*  GRUPO:  Separa el volcado de 'x': líneas de estado "Capture ...", la configuración, un bloque en hexadecimal
+            por línea y los eventos del equipo. Las líneas de fecha y los totales se ignoran.
+*/
+static inline bool replayDumpParse( const string& dump, replayCapture_t* capture )
+{
+    istringstream lines( dump );
+    string line;
+    vector<uint8_t> block;
+    unsigned int byte;
+    size_t i;
+
+    capture->config.clear();
+    capture->ticks.clear();
+    capture->eventsAvailable = false;
+    capture->eventsOverwritten = 0;
+    capture->events.clear();
+
+    while ( getline( lines, line ) ) {
+        if ( !line.empty() && line[line.size() - 1] == '\r' ) {
+            line.erase( line.size() - 1 );
+        }
+        if ( replayPrefixIs( line, REPLAY_CONFIG_PREFIX ) ) {
+            capture->config = line.substr( strlen( REPLAY_CONFIG_PREFIX ) );
+        } else if ( replayPrefixIs( line, REPLAY_EVENTS_PREFIX ) ) {
+            capture->eventsAvailable = true;
+        } else if ( replayPrefixIs( line, REPLAY_OVERWRITTEN_PREFIX ) ) {
+            capture->eventsOverwritten = atoi( line.c_str() + strlen( REPLAY_OVERWRITTEN_PREFIX ) );
+        } else if ( replayPrefixIs( line, REPLAY_EVENT_PREFIX ) ) {
+            capture->events.push_back( line.substr( strlen( REPLAY_EVENT_PREFIX ) ) );
+        } else if ( replayIsHexLine( line ) ) {
+            if ( line.size() % 2 != 0 || line.size() / 2 > sizeof( captureBlock_t::data ) ) {
+                return false;
+            }
+            block.clear();
+            for ( i = 0; i < line.size(); i += 2 ) {
+                sscanf( line.c_str() + i, "%2x", &byte );
+                block.push_back( byte );
+            }
+            if ( !replayBlockDecode( block, &capture->ticks ) ) {
+                return false;
+            }
+        }
+    }
+    return !capture->ticks.empty();
+}
+
+//GRUPO: Mismo criterio que captureReplayStartBlock() en el firmware.
+static inline size_t replayStartTick( const replayCapture_t& capture )
+{
+    size_t startTick = 0;
+    size_t i;
+
+    for ( i = 0; i < capture.ticks.size(); i++ ) {
+        if ( capture.ticks[i].hasKeyframe &&
+             ( capture.ticks[i].keyframe.flags & CAPTURE_FLAG_SEGMENT_START ) ) {
+            startTick = i;
+        }
+    }
+    return startTick;
+}
+
+/*  GRUPO:  Deja el firmware como estaba al terminar el ciclo del keyframe. Las muestras del promedio del LM35 no
+            se graban, así que el arreglo se llena con el promedio guardado; durante los primeros
+            numberOfAvgSamples ciclos el promedio reproducido puede diferir un poco del original.
+*/
+static inline void replayStateRestore( const replayTick_t& tick )
+{
+    const captureKeyframe_t* keyframe = &tick.keyframe;
+    int i;
+
+    inputs = tick.inputs;
+    alarmState = keyframe->flags & CAPTURE_FLAG_ALARM;
+    overTempDetector = keyframe->flags & CAPTURE_FLAG_OVER_TEMP_DETECTOR;
+    gasDetectorState = keyframe->flags & CAPTURE_FLAG_GAS_DETECTOR_STATE;
+    overTempDetectorState = keyframe->flags & CAPTURE_FLAG_OVER_TEMP_DETECTOR_STATE;
+    incorrectCodeLed = ( keyframe->flags & CAPTURE_FLAG_INCORRECT_CODE_LED ) ? ON : OFF;
+    systemBlockedLed = ( keyframe->flags & CAPTURE_FLAG_SYSTEM_BLOCKED_LED ) ? ON : OFF;
+    numberOfIncorrectCodes = keyframe->numberOfIncorrectCodes;
+    matrixKeypadState = (matrixKeypadState_t)keyframe->matrixKeypadState;
+    matrixKeypadLastKeyPressed = keyframe->matrixKeypadLastKeyPressed;
+    matrixKeypadCodeIndex = keyframe->matrixKeypadCodeIndex;
+    memcpy( keyPressed, keyframe->keyPressed, NUMBER_OF_KEYS );
+    accumulatedDebounceMatrixKeypadTime = keyframe->accumulatedDebounceMatrixKeypadTime;
+
+    for ( i = 0; i < NUMBER_OF_AVG_SAMPLES_MAX; i++ ) {
+        lm35ReadingsArray[i] = keyframe->lm35ReadingsAverage;
+    }
+    lm35ReadingsAverage = keyframe->lm35ReadingsAverage;
+    lm35SampleIndex = 0;
+
+    alarmLastState = alarmState;
+    gasLastState = inputs.gasDetected;
+    tempLastState = overTempDetector;
+    ICLastState = incorrectCodeLed;
+    SBLastState = systemBlockedLed;
+}
+
+//GRUPO: Solo las líneas "Event = ..."; la fecha depende del reloj de cada equipo y no se compara.
+static inline vector<string> replayEventLines( const string& log )
+{
+    istringstream lines( log );
+    vector<string> events;
+    string line;
+
+    while ( getline( lines, line ) ) {
+        if ( !line.empty() && line[line.size() - 1] == '\r' ) {
+            line.erase( line.size() - 1 );
+        }
+        if ( replayPrefixIs( line, REPLAY_EVENT_PREFIX ) ) {
+            events.push_back( line.substr( strlen( REPLAY_EVENT_PREFIX ) ) );
+        }
+    }
+    return events;
+}
+
+//GRUPO: Todo el registro del firmware, del evento más viejo al más nuevo.
+static inline vector<string> replayEventLog()
+{
+    simulatedUartTx.clear();
+    eventLogQuerySequence( 0, eventsSequence );
+    return replayEventLines( simulatedUartTx );
+}
+
+/*  GRUPO:  El ciclo del keyframe de arranque ya está incluido en el estado restaurado, así que se simula desde
+            el siguiente. code es el código del equipo si no es el de fábrica: el volcado no lo incluye.
+*/
+static inline vector<string> replayRun( const replayCapture_t& replay, const char* code )
+{
+    char line[UART_LINE_MAX_LENGTH];
+    size_t startTick = replayStartTick( replay );
+    size_t i;
+
+    firmwareInit();
+    capture->recording = false;
+    if ( !replay.config.empty() && replay.config.size() < sizeof( line ) ) {
+        strcpy( line, replay.config.c_str() );
+        systemConfigParseAndWrite( line );
+    }
+    if ( code != NULL ) {
+        memcpy( codeSequence, code, NUMBER_OF_KEYS );
+    }
+    //GRUPO: El registro del replay no se pisa aunque el del equipo sea más chico.
+    systemConfig.eventMaxStorage = EVENT_MAX_STORAGE_MAX;
+    eventLogClear();
+
+    replayStateRestore( replay.ticks[startTick] );
+    for ( i = startTick + 1; i < replay.ticks.size(); i++ ) {
+        simulatedAdcValue = replay.ticks[i].inputs.lm35Raw << 4;
+        simulatedPinValue[PE_12] = !replay.ticks[i].inputs.gasDetected;
+        simulatedPinValue[BUTTON1] = replay.ticks[i].inputs.alarmTestButtonPressed;
+        simulatedKey = (int)replay.ticks[i].inputs.keyScanned - 1;
+        firmwareTick();
+    }
+    return replayEventLog();
+}
+
+//GRUPO: Imprime la primera diferencia entre los dos registros. Devuelve true si son iguales.
+static inline bool replayEventsCompare( const vector<string>& expected, const vector<string>& replayed )
+{
+    size_t i;
+
+    for ( i = 0; i < expected.size() && i < replayed.size(); i++ ) {
+        if ( expected[i] != replayed[i] ) {
+            fprintf( stderr, "event %zu: expected %s, replayed %s\n", i + 1,
+                     expected[i].c_str(), replayed[i].c_str() );
+            return false;
+        }
+    }
+    if ( expected.size() != replayed.size() ) {
+        fprintf( stderr, "expected %zu events, replayed %zu\n", expected.size(), replayed.size() );
+        return false;
+    }
+    return true;
+}
+
+//GRUPO: Los eventos que el equipo ya pisó en su buffer circular se descartan del principio del replay.
+static inline bool replayCaptureCompare( const replayCapture_t& replay, vector<string> replayed )
+{
+    size_t overwritten = replay.eventsOverwritten;
+
+    if ( overwritten > replayed.size() ) {
+        overwritten = replayed.size();
+    }
+    replayed.erase( replayed.begin(), replayed.begin() + overwritten );
+    return replayEventsCompare( replay.events, replayed );
+}
+
+//=====[#include guards - end]=================================================
+
+#endif // _REPLAY_H_
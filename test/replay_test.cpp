@@ -0,0 +1,278 @@
+//=====[Libraries]=============================================================
+
+#include "replay.h"
+
+#include <algorithm>
+
+//=====[Declaration of public defines]=========================================
+
+#define LM35_RAW_ROOM           250
+#define LM35_RAW_HOT            900
+#define KEY_TICKS                10
+
+//=====[Implementations of public functions]===================================
+
+//GRUPO: Ciclos con las mismas entradas; el LM35 tiene un poco de ruido como en la placa.
+static void recordTicks( int numberOfTicks, int lm35Raw, bool gas, bool button )
+{
+    int i;
+
+    for ( i = 0; i < numberOfTicks; i++ ) {
+        simulatedAdcValue = ( lm35Raw + simulatedTicks % 5 - 2 ) << 4;
+        simulatedPinValue[PE_12] = !gas;
+        simulatedPinValue[BUTTON1] = button;
+        firmwareTick();
+    }
+}
+
+//GRUPO: Cada tecla se mantiene y se suelta el tiempo suficiente para pasar el antirrebote.
+static void recordKeys( const char* keys )
+{
+    const char* key;
+
+    for ( ; *keys != '\0'; keys++ ) {
+        key = (const char*)memchr( matrixKeypadIndexToCharArray, *keys, sizeof( matrixKeypadIndexToCharArray ) );
+        simulatedKey = key - matrixKeypadIndexToCharArray;
+        recordTicks( KEY_TICKS, LM35_RAW_ROOM, false, false );
+        simulatedKey = -1;
+        recordTicks( KEY_TICKS, LM35_RAW_ROOM, false, false );
+    }
+}
+
+static string captureDumpText()
+{
+    simulatedUartTx.clear();
+    captureDump();
+    return simulatedUartTx;
+}
+
+static bool captureContains( const vector<string>& events, const char* event )
+{
+    return find( events.begin(), events.end(), string( event ) ) != events.end();
+}
+
+//GRUPO: Gas, código correcto, sobretemperatura, botón de prueba y código incorrecto.
+static void recordScenario()
+{
+    firmwareInit();
+    captureStart();
+    recordTicks( 200, LM35_RAW_ROOM, false, false );
+    recordTicks( 100, LM35_RAW_ROOM, true, false );
+    recordTicks( 100, LM35_RAW_ROOM, false, false );
+    recordKeys( "1805#" );
+    recordTicks( 300, LM35_RAW_HOT, false, false );
+    recordTicks( 300, LM35_RAW_ROOM, false, false );
+    recordKeys( "1805#" );
+    recordTicks( 20, LM35_RAW_ROOM, false, true );
+    recordTicks( 50, LM35_RAW_ROOM, false, false );
+    recordKeys( "1111#" );
+    recordTicks( 50, LM35_RAW_ROOM, false, false );
+    capture->recording = false;
+}
+
+static void replayMatchesTest()
+{
+    replayCapture_t replay;
+
+    recordScenario();
+    CHECK( replayDumpParse( captureDumpText(), &replay ) );
+    CHECK( replay.ticks.size() == capture->ticksRecorded );
+    CHECK( replayStartTick( replay ) == 0 );
+    CHECK( replay.config == "50,100,40,1000,500,100,100" );
+    CHECK( replay.eventsAvailable );
+    CHECK( replay.events.size() >= 10 );
+    CHECK( captureContains( replay.events, "OVER_TEMP_ON" ) );
+    CHECK( captureContains( replay.events, "LED_IC_ON" ) );
+    CHECK( replayCaptureCompare( replay, replayRun( replay, NULL ) ) );
+}
+
+//GRUPO: Con otro código el replay no desactiva la alarma, así la comparación no pasa por casualidad.
+static void replayMismatchTest()
+{
+    replayCapture_t replay;
+
+    recordScenario();
+    CHECK( replayDumpParse( captureDumpText(), &replay ) );
+    fprintf( stderr, "(expected mismatch) " );
+    CHECK( !replayCaptureCompare( replay, replayRun( replay, "0000" ) ) );
+}
+
+/*  GRUPO:  El buffer da la vuelta con la alarma ya activada: el bloque más viejo que queda empieza con la alarma
+            encendida y el único evento de la ventana es ALARM_OFF al ingresar el código.
+*/
+static void wrapWhileLatchedTest()
+{
+    replayCapture_t replay;
+    vector<string> replayed;
+    size_t startTick;
+
+    firmwareInit();
+    captureStart();
+    recordTicks( 100, LM35_RAW_ROOM, true, false );
+    recordTicks( 6000, LM35_RAW_ROOM, false, false );
+    recordKeys( "1805#" );
+    recordTicks( 50, LM35_RAW_ROOM, false, false );
+    capture->recording = false;
+
+    CHECK( capture->numberOfBlocks == CAPTURE_NUMBER_OF_BLOCKS );
+    CHECK( replayDumpParse( captureDumpText(), &replay ) );
+    CHECK( replay.ticks.size() < capture->ticksRecorded );
+    startTick = replayStartTick( replay );
+    CHECK( startTick == 0 );
+    CHECK( replay.ticks[startTick].keyframe.flags & CAPTURE_FLAG_ALARM );
+    CHECK( replay.events.size() == 1 && replay.events[0] == "ALARM_OFF" );
+
+    replayed = replayRun( replay, NULL );
+    CHECK( replayed.size() == 1 );
+    CHECK( replayCaptureCompare( replay, replayed ) );
+}
+
+/*  GRUPO:  Un reset en medio de la captura deja la alarma apagada y vacía el registro. El replay arranca en el
+            tramo posterior al reset y se compara solo con los eventos de después.
+*/
+static void resetDuringCaptureTest()
+{
+    replayCapture_t replay;
+    size_t startTick;
+
+    firmwareInit();
+    captureStart();
+    recordTicks( 100, LM35_RAW_ROOM, true, false );
+    recordTicks( 300, LM35_RAW_ROOM, false, false );
+    CHECK( alarmState == ON );
+
+    firmwareInit();
+    recordTicks( 200, LM35_RAW_ROOM, false, false );
+    recordTicks( 20, LM35_RAW_ROOM, false, true );
+    recordTicks( 50, LM35_RAW_ROOM, false, false );
+    recordKeys( "1805#" );
+    recordTicks( 50, LM35_RAW_ROOM, false, false );
+    capture->recording = false;
+
+    CHECK( replayDumpParse( captureDumpText(), &replay ) );
+    startTick = replayStartTick( replay );
+    CHECK( startTick > 0 );
+    CHECK( !( replay.ticks[startTick].keyframe.flags & CAPTURE_FLAG_ALARM ) );
+    CHECK( replay.events.size() == 2 && replay.events[0] == "ALARM_ON" && replay.events[1] == "ALARM_OFF" );
+    CHECK( replayCaptureCompare( replay, replayRun( replay, NULL ) ) );
+}
+
+//GRUPO: Si el equipo ya pisó los primeros eventos de la ventana, se comparan solo los que quedan.
+static void eventsOverwrittenTest()
+{
+    char line[UART_LINE_MAX_LENGTH];
+    replayCapture_t replay;
+
+    firmwareInit();
+    strcpy( line, ",,,,,,4" );
+    CHECK( systemConfigParseAndWrite( line ) );
+    captureStart();
+    recordTicks( 200, LM35_RAW_ROOM, false, false );
+    recordTicks( 100, LM35_RAW_ROOM, true, false );
+    recordTicks( 100, LM35_RAW_ROOM, false, false );
+    recordKeys( "1805#" );
+    recordTicks( 20, LM35_RAW_ROOM, false, true );
+    recordTicks( 50, LM35_RAW_ROOM, false, false );
+    recordKeys( "1805#" );
+    capture->recording = false;
+
+    CHECK( replayDumpParse( captureDumpText(), &replay ) );
+    CHECK( replay.eventsOverwritten > 0 );
+    CHECK( replay.events.size() == 4 );
+    CHECK( replayCaptureCompare( replay, replayRun( replay, NULL ) ) );
+}
+
+//GRUPO: Después de un reset sin grabar, el registro en RAM ya no corresponde a la captura.
+static void eventsNotAvailableTest()
+{
+    replayCapture_t replay;
+
+    recordScenario();
+    firmwareInit();
+    CHECK( replayDumpParse( captureDumpText(), &replay ) );
+    CHECK( !replay.eventsAvailable );
+    CHECK( replay.events.empty() );
+}
+
+static string keyframeHex( uint16_t lm35Raw )
+{
+    captureKeyframe_t keyframe;
+    const uint8_t* bytes = (const uint8_t*)&keyframe;
+    string hex;
+    char str[3];
+    size_t i;
+
+    memset( &keyframe, 0, sizeof( keyframe ) );
+    keyframe.lm35Raw = lm35Raw;
+    keyframe.flags = CAPTURE_FLAG_SEGMENT_START;
+    for ( i = 0; i < sizeof( keyframe ); i++ ) {
+        sprintf( str, "%02X", bytes[i] );
+        hex += str;
+    }
+    return hex;
+}
+
+static void invalidDumpTest()
+{
+    replayCapture_t replay;
+
+    CHECK( !replayDumpParse( "Capture off: 0 ticks, 0 blocks, 0 bytes\r\n", &replay ) );
+    CHECK( !replayDumpParse( keyframeHex( 250 ).substr( 0, 20 ) + "\r\n", &replay ) );
+    CHECK( !replayDumpParse( keyframeHex( 250 ) + "A\r\n", &replay ) );
+    CHECK( !replayDumpParse( keyframeHex( 250 ) + "80\r\n", &replay ) );
+    CHECK( replayDumpParse( keyframeHex( 250 ) + "04\r\n", &replay ) );
+    CHECK( replay.ticks.size() == 2 && replay.ticks[1].inputs.lm35Raw == 252 );
+}
+
+static void captureSurvivesResetTest()
+{
+    uint32_t ticksRecorded;
+
+    recordScenario();
+    ticksRecorded = capture->ticksRecorded;
+    captureInit();
+    CHECK( capture->ticksRecorded == ticksRecorded );
+    CHECK( capture->numberOfBlocks > 1 );
+}
+
+//GRUPO: Una captura nueva no suma los bloques que quedaron de la anterior.
+static void restartStatusTest()
+{
+    recordScenario();
+    captureStart();
+    recordTicks( 10, LM35_RAW_ROOM, false, false );
+    capture->recording = false;
+    CHECK( captureDumpText().find( "10 ticks, 1 blocks, 33 bytes" ) != string::npos );
+}
+
+//GRUPO: Sin VBAT la SRAM de backup puede quedar con el magic bien y un largo de bloque imposible.
+static void corruptLengthTest()
+{
+    int i;
+
+    recordScenario();
+    capture->blocks[CAPTURE_NUMBER_OF_BLOCKS - 1].length = sizeof( capture->blocks[0].data ) + 1;
+    captureInit();
+    CHECK( capture->magic == CAPTURE_MAGIC );
+    CHECK( capture->numberOfBlocks == 0 );
+    CHECK( capture->ticksRecorded == 0 );
+    for ( i = 0; i < CAPTURE_NUMBER_OF_BLOCKS; i++ ) {
+        CHECK( capture->blocks[i].length == 0 );
+    }
+    CHECK( captureDumpText().find( "0 bytes" ) != string::npos );
+}
+
+int main()
+{
+    replayMatchesTest();
+    replayMismatchTest();
+    wrapWhileLatchedTest();
+    resetDuringCaptureTest();
+    eventsOverwrittenTest();
+    eventsNotAvailableTest();
+    invalidDumpTest();
+    captureSurvivesResetTest();
+    restartStatusTest();
+    corruptLengthTest();
+    return checkResult( "replay_test" );
+}
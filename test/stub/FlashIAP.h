@@ -0,0 +1,57 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _FLASH_IAP_H_STUB_
+#define _FLASH_IAP_H_STUB_
+
+//GRUPO: Flash simulada en RAM con la misma geometría que el final de la flash del F429 (sectores de 128 KB).
+
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+
+//=====[Declaration of public defines]=========================================
+
+#define SIMULATED_FLASH_START          0x08000000
+#define SIMULATED_FLASH_SECTOR_SIZE    ( 128 * 1024 )
+#define SIMULATED_FLASH_SIZE           ( 2 * SIMULATED_FLASH_SECTOR_SIZE )
+
+//=====[Declaration and initialization of public global variables]=============
+
+static uint8_t simulatedFlash[SIMULATED_FLASH_SIZE];
+static int simulatedFlashErases = 0;
+
+//=====[Implementations of public functions]===================================
+
+class FlashIAP {
+public:
+    int init() { return 0; }
+    uint32_t get_flash_start() { return SIMULATED_FLASH_START; }
+    uint32_t get_flash_size() { return SIMULATED_FLASH_SIZE; }
+    uint32_t get_sector_size( uint32_t address ) { return SIMULATED_FLASH_SECTOR_SIZE; }
+    uint32_t get_page_size() { return 1; }
+    uint8_t get_erase_value() { return 0xFF; }
+    int read( void* buffer, uint32_t address, uint32_t size )
+    {
+        memcpy( buffer, &simulatedFlash[address - SIMULATED_FLASH_START], size );
+        return 0;
+    }
+    int erase( uint32_t address, uint32_t size )
+    {
+        memset( &simulatedFlash[address - SIMULATED_FLASH_START], 0xFF, size );
+        simulatedFlashErases++;
+        return 0;
+    }
+    //GRUPO: Como en la flash real, programar solo puede pasar bits de 1 a 0.
+    int program( const void* buffer, uint32_t address, uint32_t size )
+    {
+        uint32_t i;
+        for ( i = 0; i < size; i++ ) {
+            simulatedFlash[address - SIMULATED_FLASH_START + i] &= ((const uint8_t*)buffer)[i];
+        }
+        return 0;
+    }
+};
+
+//=====[#include guards - end]=================================================
+
+#endif // _FLASH_IAP_H_STUB_
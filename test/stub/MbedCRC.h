@@ -0,0 +1,43 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _MBED_CRC_H_STUB_
+#define _MBED_CRC_H_STUB_
+
+//GRUPO: CRC-32 ANSI (el mismo que calcula MbedCRC<POLY_32BIT_ANSI, 32>).
+
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+
+//=====[Declaration of public data types]======================================
+
+typedef enum {
+    POLY_32BIT_ANSI = 0x04C11DB7
+} crc_polynomial_t;
+
+//=====[Implementations of public functions]===================================
+
+template <uint32_t polynomial, int width>
+class MbedCRC {
+public:
+    int compute( const void* buffer, size_t size, uint32_t* crc )
+    {
+        const uint8_t* data = (const uint8_t*)buffer;
+        uint32_t value = 0xFFFFFFFF;
+        size_t i;
+        int bit;
+
+        for ( i = 0; i < size; i++ ) {
+            value ^= data[i];
+            for ( bit = 0; bit < 8; bit++ ) {
+                value = ( value >> 1 ) ^ ( 0xEDB88320 & -( value & 1 ) );
+            }
+        }
+        *crc = ~value;
+        return 0;
+    }
+};
+
+//=====[#include guards - end]=================================================
+
+#endif // _MBED_CRC_H_STUB_
@@ -0,0 +1,162 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _MBED_H_STUB_
+#define _MBED_H_STUB_
+
+/*  GRUPO:  HAL simulado para compilar main.cpp en la PC. Solo implementa lo que usa el firmware; las entradas
+            se manejan desde los tests con las variables simulated*.
+*/
+
+//=====[Libraries]=============================================================
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//=====[Declaration of public defines]=========================================
+
+#define KEYPAD_SIMULATED_ROWS   4
+#define KEYPAD_SIMULATED_COLS   4
+
+//=====[Declaration of public data types]======================================
+
+typedef enum {
+    BUTTON1, PE_12, PE_10, LED1, LED2, LED3, USBTX, USBRX, A1,
+    PB_3, PB_5, PC_7, PA_15, PB_12, PB_13, PB_15, PC_6,
+    PIN_NAME_NUMBER
+} PinName;
+
+typedef enum {
+    PullNone, PullUp, PullDown, OpenDrain
+} PinMode;
+
+//=====[Declaration and initialization of public global variables]=============
+
+static int simulatedPinValue[PIN_NAME_NUMBER];
+static int simulatedKey = -1;
+static uint16_t simulatedAdcValue = 0;
+static time_t simulatedSeconds = 0;
+static string simulatedUartRx;
+static size_t simulatedUartRxIndex = 0;
+static string simulatedUartTx;
+
+static const PinName simulatedRowPins[KEYPAD_SIMULATED_ROWS] = { PB_3, PB_5, PC_7, PA_15 };
+static const PinName simulatedColPins[KEYPAD_SIMULATED_COLS] = { PB_12, PB_13, PB_15, PC_6 };
+
+//=====[Implementations of public functions]===================================
+
+//GRUPO: Una columna del teclado está en 0 si la tecla simulada está en esa columna y su fila está en 0.
+static inline int simulatedPinRead( PinName pin )
+{
+    int col;
+    for ( col = 0; col < KEYPAD_SIMULATED_COLS; col++ ) {
+        if ( simulatedColPins[col] == pin ) {
+            if ( simulatedKey >= 0 && simulatedKey % KEYPAD_SIMULATED_COLS == col &&
+                 simulatedPinValue[simulatedRowPins[simulatedKey / KEYPAD_SIMULATED_COLS]] == 0 ) {
+                return 0;
+            }
+            return 1;
+        }
+    }
+    return simulatedPinValue[pin];
+}
+
+class DigitalIn {
+public:
+    DigitalIn( PinName pin ) : _pin( pin ) {}
+    void mode( PinMode pull ) {}
+    int read() { return simulatedPinRead( _pin ); }
+    operator int() { return read(); }
+private:
+    PinName _pin;
+};
+
+class DigitalOut {
+public:
+    DigitalOut( PinName pin ) : _pin( pin ) {}
+    void write( int value ) { simulatedPinValue[_pin] = value; }
+    int read() { return simulatedPinValue[_pin]; }
+    DigitalOut& operator=( int value ) { write( value ); return *this; }
+    operator int() { return read(); }
+private:
+    PinName _pin;
+};
+
+class DigitalInOut {
+public:
+    DigitalInOut( PinName pin ) : _pin( pin ) {}
+    void mode( PinMode pull ) {}
+    void input() {}
+    void output() {}
+    DigitalInOut& operator=( int value ) { simulatedPinValue[_pin] = value; return *this; }
+    operator int() { return simulatedPinValue[_pin]; }
+private:
+    PinName _pin;
+};
+
+class AnalogIn {
+public:
+    AnalogIn( PinName pin ) {}
+    unsigned short read_u16() { return simulatedAdcValue; }
+    float read() { return simulatedAdcValue / 65535.0f; }
+};
+
+class BufferedSerial {
+public:
+    BufferedSerial( PinName tx, PinName rx, int baud ) {}
+    bool readable() { return simulatedUartRxIndex < simulatedUartRx.size(); }
+    ssize_t read( void* buffer, size_t length )
+    {
+        size_t i;
+        for ( i = 0; i < length && readable(); i++ ) {
+            ((char*)buffer)[i] = simulatedUartRx[simulatedUartRxIndex++];
+        }
+        return i;
+    }
+    ssize_t write( const void* buffer, size_t length )
+    {
+        simulatedUartTx.append( (const char*)buffer, length );
+        return length;
+    }
+};
+
+static inline time_t simulatedTime( time_t* seconds )
+{
+    if ( seconds != NULL ) {
+        *seconds = simulatedSeconds;
+    }
+    return simulatedSeconds;
+}
+#define time( seconds ) simulatedTime( seconds )
+
+static inline void set_time( time_t seconds )
+{
+    simulatedSeconds = seconds;
+}
+
+static inline uint32_t us_ticker_read()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+static inline void thread_sleep_for( int ms ) {}
+
+//GRUPO: Carga una trama en el buffer de recepción como si la mandara un script de una sola vez.
+static inline void simulatedUartSend( const char* str )
+{
+    simulatedUartRx.erase( 0, simulatedUartRxIndex );
+    simulatedUartRxIndex = 0;
+    simulatedUartRx.append( str );
+}
+
+//=====[#include guards - end]=================================================
+
+#endif // _MBED_H_STUB_
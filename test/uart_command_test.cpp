@@ -0,0 +1,103 @@
+//=====[Libraries]=============================================================
+
+#include "firmware.h"
+
+//=====[Implementations of public functions]===================================
+
+static void rtcTimeParseTest()
+{
+    time_t seconds = 0;
+
+    CHECK( rtcTimeParse( "2026-10-16T12:00:00", &seconds ) && seconds == 1792152000 );
+    CHECK( rtcTimeParse( "2026-10-16 12:00:00", &seconds ) && seconds == 1792152000 );
+    CHECK( rtcTimeParse( "1760616000", &seconds ) && seconds == 1760616000 );
+    CHECK( rtcTimeParse( "2024-02-29T00:00:00", &seconds ) );
+    CHECK( !rtcTimeParse( "2025-02-29T00:00:00", &seconds ) );
+    CHECK( !rtcTimeParse( "2026-13-01T00:00:00", &seconds ) );
+    CHECK( !rtcTimeParse( "2026-10-16T24:00:00", &seconds ) );
+    CHECK( !rtcTimeParse( "2026-1a-16T12:00:00", &seconds ) );
+    CHECK( !rtcTimeParse( "1969-12-31T23:59:59", &seconds ) );
+    CHECK( !rtcTimeParse( "", &seconds ) );
+
+    //GRUPO: Los dos formatos comparten el límite superior.
+    CHECK( rtcTimeParse( "2038-01-19T03:14:07", &seconds ) && seconds == RTC_EPOCH_MAX );
+    CHECK( !rtcTimeParse( "2038-01-19T03:14:08", &seconds ) );
+    CHECK( !rtcTimeParse( "9999-12-31T23:59:59", &seconds ) );
+    CHECK( rtcTimeParse( "2147483647", &seconds ) && seconds == RTC_EPOCH_MAX );
+    CHECK( !rtcTimeParse( "2147483648", &seconds ) );
+}
+
+static void singleFrameTest()
+{
+    int i;
+
+    firmwareInit();
+    simulatedUartSend( "d2026-10-16T12:00:00\r\n" );
+    for ( i = 0; i < 3; i++ ) {
+        firmwareTick();
+    }
+    CHECK( simulatedSeconds == 1792152000 );
+    CHECK( simulatedUartTx.find( "Date and time has been set" ) != string::npos );
+    CHECK( simulatedUartTx.find( "Available commands" ) == string::npos );
+
+    simulatedUartTx.clear();
+    simulatedUartSend( "b1760616000,4321,60\r\nd2026-10-16T12:00:00\r\n" );
+    for ( i = 0; i < 6; i++ ) {
+        firmwareTick();
+    }
+    CHECK( memcmp( codeSequence, "4321", NUMBER_OF_KEYS ) == 0 );
+    CHECK( systemConfig.overTempLevel == 60 );
+    CHECK( simulatedSeconds >= 1792152000 );
+    CHECK( simulatedUartTx.find( "Configuration has been set" ) != string::npos );
+    CHECK( simulatedUartTx.find( "Available commands" ) == string::npos );
+}
+
+//GRUPO: La trama llega partida entre ciclos y el loop sigue corriendo mientras tanto.
+static void splitFrameTest()
+{
+    firmwareInit();
+    simulatedUartSend( "d17606" );
+    firmwareTick();
+    CHECK( uartLineCommand == 'd' );
+    simulatedUartSend( "16000\n" );
+    firmwareTick();
+    CHECK( uartLineCommand == '\0' );
+    CHECK( simulatedSeconds == 1760616000 );
+}
+
+static void invalidFrameTest()
+{
+    int i;
+
+    firmwareInit();
+    simulatedUartSend( "d2026-10-16T12:00\r" );
+    firmwareTick();
+    firmwareTick();
+    CHECK( simulatedUartTx.find( "Invalid date and time" ) != string::npos );
+
+    simulatedUartTx.clear();
+    simulatedUartSend( "b,12,\r" );
+    firmwareTick();
+    firmwareTick();
+    CHECK( simulatedUartTx.find( "Invalid configuration" ) != string::npos );
+
+    //GRUPO: Sin terminador la línea se descarta por timeout.
+    simulatedUartTx.clear();
+    simulatedUartSend( "d2026" );
+    firmwareTick();
+    CHECK( uartLineCommand == 'd' );
+    for ( i = 0; i <= UART_LINE_TIMEOUT_MS / TIME_INCREMENT_MS; i++ ) {
+        firmwareTick();
+    }
+    CHECK( uartLineCommand == '\0' );
+    CHECK( simulatedUartTx.find( "Invalid date and time" ) != string::npos );
+}
+
+int main()
+{
+    rtcTimeParseTest();
+    singleFrameTest();
+    splitFrameTest();
+    invalidFrameTest();
+    return checkResult( "uart_command_test" );
+}